@@ -4,6 +4,8 @@
 #include "board/draw_rules.hpp"
 #include "board/initialization.hpp"
 #include "board/move_generation.hpp"
+#include "board/zobrist.hpp"
+#include "engine/piece_square_tables.hpp"
 #include <algorithm>
 #include <iostream>
 
@@ -11,109 +13,126 @@ namespace chess {
 
 Board::Board(const std::string &fen) {
     BoardInitializer::setup_initial_position(*this, fen);
-    add_position_to_history();
 }
 
-void Board::add_position_to_history() {
-    position_history_.push_back(BoardInitializer::export_to_fen(*this));
-    if (position_history_.size() > 8) { // Keep last 8 positions (half-moves)
-        position_history_.pop_front();
-    }
+void Board::set_piece(std::pair<int, int> square, const Piece &piece) {
+    std::uint8_t &slot = piece_codes_[square.second * 8 + square.first];
+    update_scores(square, Piece::from_code(slot), -1);
+    slot = piece.code();
+    update_scores(square, piece, 1);
 }
 
-bool Board::make_move(std::pair<int, int> from, std::pair<int, int> to,
-                      PieceType promotion) {
-    if (!in_bounds(from.first, from.second) ||
-        !in_bounds(to.first, to.second)) {
-        return false;
-    }
-
-    const Piece &piece = get_piece(from);
-    if (piece.get_type() == PieceType::NONE ||
-        piece.get_color() != current_player) {
-        return false;
-    }
+void Board::update_scores(std::pair<int, int> square, const Piece &piece,
+                          int sign) {
+    if (piece.get_type() == PieceType::NONE)
+        return;
+
+    const int index = color_index(piece.get_color());
+    psq_middlegame_[index] += sign * engine::PieceSquareTables::get_value(
+                                         piece.get_type(), square,
+                                         piece.get_color(), false);
+
+    if (piece.get_type() == PieceType::HIGHLIGHT)
+        return;
+    piece_key_ ^= zobrist::KEYS[zobrist::piece_key_index(
+        piece.get_type(), piece.get_color(), square)];
+
+    if (piece.get_type() == PieceType::KING) {
+        // A move puts the king on its new square before clearing the old one
+        const int king_square = square.second * 8 + square.first;
+        if (sign > 0)
+            king_squares_[index] = static_cast<std::int8_t>(king_square);
+        else if (king_squares_[index] == king_square)
+            king_squares_[index] = -1;
+        return;
+    }
+    std::uint64_t delta = 1ULL
+                          << material_shift(piece.get_color(), piece.get_type());
+    if (piece.get_type() == PieceType::BISHOP &&
+        (square.first + square.second) % 2 == 0) {
+        delta += 1ULL << (LIGHT_BISHOP_SHIFT + 4 * index);
+    }
+    material_key_ = sign > 0 ? material_key_ + delta : material_key_ - delta;
+}
 
-    // Handle castling
-    if (piece.get_type() == PieceType::KING &&
-        abs(from.first - to.first) == 2) {
-        bool success = CastlingManager::try_perform_castle(*this, from, to);
-        if (success) {
-            add_position_to_history();
-        }
-        return success;
-    }
+int Board::psq_score(Color color, bool endgame) const {
+    const int index = color_index(color);
+    const int king = king_squares_[index];
+    if (!endgame || king < 0)
+        return psq_middlegame_[index];
+    const Position square{king % 8, king / 8};
+    return psq_middlegame_[index] +
+           engine::PieceSquareTables::get_value(PieceType::KING, square, color,
+                                                true) -
+           engine::PieceSquareTables::get_value(PieceType::KING, square, color,
+                                                false);
+}
 
-    auto legal_moves = get_legal_moves(from);
-    auto it = std::find_if(legal_moves.begin(), legal_moves.end(),
-                           [&to](const std::pair<int, int> &move) {
-                               return move.first == to.first &&
-                                      move.second == to.second;
-                           });
+std::uint64_t Board::hash() const {
+    return piece_key_ ^ zobrist::state_key(*this);
+}
 
-    if (it == legal_moves.end()) {
+bool Board::make_move(std::pair<int, int> from, std::pair<int, int> to,
+                      PieceType promotion) {
+    const Move move{from, to, promotion};
+    if (!is_legal(move)) {
         return false;
     }
+    apply_move(move);
+    return true;
+}
 
-    // Handle en passant
-    if (piece.get_type() == PieceType::PAWN && from.first != to.first &&
-        is_empty(to) && en_passant_target_ && to == *en_passant_target_) {
-        // Remove the captured pawn
-        grid_[from.second][to.first] = Piece();
-    }
+void Board::apply_move(const Move &move) {
+    const auto [from, to] = std::make_pair(move.from, move.to);
+    // A copy: the source square is cleared below
+    const Piece piece = get_piece(from);
+    const PieceType type = piece.get_type();
+    const bool capture = !is_empty(to);
 
-    // Update en passant target
-    if (piece.get_type() == PieceType::PAWN &&
-        abs(from.second - to.second) == 2) {
-        // Для белых пешек: поле за пешкой (ниже по доске)
-        // Для чёрных пешек: поле за пешкой (выше по доске)
-        int direction = piece.get_color() == Color::WHITE ? -1 : 1;
-        en_passant_target_ = {from.first, from.second + direction};
-    } else {
-        en_passant_target_ = std::nullopt;
+    // Rights go before anything moves: a rook captured on its corner
+    // loses its right as well
+    CastlingManager::update_castling_rights(*this, to);
+    CastlingManager::update_castling_rights(*this, from);
+
+    if (type == PieceType::PAWN && from.first != to.first && !capture) {
+        // En passant: the captured pawn stands beside the mover
+        set_piece({to.first, from.second}, Piece());
+    } else if (type == PieceType::KING && abs(to.first - from.first) == 2) {
+        // Castling: the rook lands on the square the king passed
+        const int rook_x = to.first > from.first ? 7 : 0;
+        const Piece rook = get_piece({rook_x, from.second});
+        set_piece({rook_x, from.second}, Piece());
+        set_piece({(from.first + to.first) / 2, from.second}, rook);
     }
 
-    // Handle promotion
     Piece moved_piece = piece;
-    if (piece.get_type() == PieceType::PAWN &&
-        (to.second == 0 || to.second == 7)) {
-        moved_piece.set_type(promotion == PieceType::NONE ? PieceType::QUEEN
-                                                          : promotion);
+    if (type == PieceType::PAWN && (to.second == 0 || to.second == 7)) {
+        moved_piece.set_type(move.promotion == PieceType::NONE
+                                 ? PieceType::QUEEN
+                                 : move.promotion);
+    }
+    set_piece(to, moved_piece);
+    set_piece(from, Piece());
+
+    if (type == PieceType::PAWN && abs(from.second - to.second) == 2) {
+        // The square the pawn passed over
+        set_en_passant_target(
+            Position{from.first, (from.second + to.second) / 2});
+    } else {
+        set_en_passant_target(std::nullopt);
     }
 
-    // Save previous state for halfmove clock
-    bool reset_halfmove =
-        (piece.get_type() == PieceType::PAWN) ||
-        (!is_empty(to) || (en_passant_target_ && to == *en_passant_target_));
-
-    // Execute move
-    grid_[to.second][to.first] = moved_piece;
-    grid_[from.second][from.first] = Piece();
-    CastlingManager::update_castling_rights(*this, from);
-
-    // Update halfmove clock and fullmove number
-    if (reset_halfmove) {
+    if (type == PieceType::PAWN || capture) {
         halfmove_clock_ = 0;
     } else {
         halfmove_clock_++;
     }
-
     if (current_player == Color::BLACK) {
         fullmove_number_++;
     }
 
-    // Check for self-check
-    if (CheckValidator::is_check(*this, current_player)) {
-        // Rollback move
-        grid_[from.second][from.first] = piece;
-        grid_[to.second][to.first] = Piece();
-        return false;
-    }
-
     current_player =
         (current_player == Color::WHITE) ? Color::BLACK : Color::WHITE;
-    add_position_to_history();
-    return true;
 }
 
 std::vector<std::pair<int, int>>
@@ -121,6 +140,14 @@ Board::get_legal_moves(std::pair<int, int> position) const {
     return MoveGenerator::get_legal_moves(*this, position);
 }
 
+bool Board::is_legal(const Move &move) const {
+    return MoveGenerator::is_legal(*this, move);
+}
+
+bool Board::is_pseudo_legal(const Move &move) const {
+    return MoveGenerator::is_pseudo_legal(*this, move);
+}
+
 bool Board::is_check(Color player) const {
     return CheckValidator::is_check(*this, player);
 }
@@ -129,33 +156,47 @@ bool Board::is_checkmate(Color player) {
     return CheckValidator::is_checkmate(*this, player);
 }
 
+bool Board::has_legal_move(Color player) const {
+    return CheckValidator::has_legal_move(*this, player);
+}
+
 bool Board::is_attacked(std::pair<int, int> square, Color by_color) const {
     return CheckValidator::is_attacked(*this, square, by_color);
 }
 
 bool Board::is_draw() const { return DrawRules::is_draw(*this); }
 
+bool Board::is_draw(const PositionHistory &history) const {
+    return DrawRules::is_draw(*this, history);
+}
+
+bool Board::is_search_draw(const PositionHistory &history) const {
+    return DrawRules::is_search_draw(*this, history);
+}
+
 bool Board::is_stalemate(Color player) {
     return DrawRules::is_stalemate(*this, player);
 }
 
 bool Board::is_empty(std::pair<int, int> square) const {
     return in_bounds(square.first, square.second) &&
-           grid_[square.second][square.first].get_type() == PieceType::NONE;
+           get_piece(square).get_type() == PieceType::NONE;
 }
 
 bool Board::is_enemy(std::pair<int, int> square, Color ally_color) const {
-    return in_bounds(square.first, square.second) &&
-           grid_[square.second][square.first].get_type() != PieceType::NONE &&
-           grid_[square.second][square.first].get_color() != ally_color;
+    if (!in_bounds(square.first, square.second))
+        return false;
+    const Piece piece = get_piece(square);
+    return piece.get_type() != PieceType::NONE &&
+           piece.get_color() != ally_color;
 }
 
-void Board::print(bool show_highlights) const {
+void Board::print(bool show_highlights, PieceSet set) const {
     std::cout << "\n   a  b  c  d  e  f  g  h\n";
     for (int y = 0; y < 8; ++y) {
         std::cout << 8 - y << " ";
         for (int x = 0; x < 8; ++x) {
-            const Piece &piece = grid_[y][x];
+            const Piece piece = get_piece({x, y});
             CellColor cell_color =
                 (x + y) % 2 ? CellColor::BLACK : CellColor::WHITE;
 
@@ -164,9 +205,7 @@ void Board::print(bool show_highlights) const {
                                          : CellColor::HIGHLIGHT_WHITE;
             }
 
-            Piece temp_piece = piece;
-            temp_piece.set_cell_color(cell_color);
-            std::cout << temp_piece.getColoredSymbol(piece_set_);
+            std::cout << piece.getColoredSymbol(cell_color, set);
         }
         std::cout << " " << 8 - y << "\n";
     }
@@ -186,34 +225,20 @@ void Board::highlight_moves(const std::vector<std::pair<int, int>> &moves) {
     for (const auto &[x, y] : moves) {
         if (in_bounds(x, y)) {
             if (is_empty({x, y}) || is_enemy({x, y}, current_player)) {
-                grid_[y][x] = Piece(PieceType::HIGHLIGHT, Color::WHITE);
+                set_piece({x, y}, Piece(PieceType::HIGHLIGHT, Color::WHITE));
             }
         }
     }
 }
 
 void Board::clear_highlights() {
-    for (auto &row : grid_) {
-        for (auto &square : row) {
-            if (square.get_type() == PieceType::HIGHLIGHT) {
-                square = Piece();
-            }
-        }
-    }
-}
-
-Position Board::find_king(Color color) const {
     for (int y = 0; y < 8; ++y) {
         for (int x = 0; x < 8; ++x) {
-            Position pos{x, y};
-            const auto &piece = get_piece(pos);
-            if (piece.get_type() == PieceType::KING &&
-                piece.get_color() == color) {
-                return pos;
+            if (get_piece({x, y}).get_type() == PieceType::HIGHLIGHT) {
+                set_piece({x, y}, Piece());
             }
         }
     }
-    return {-1, -1}; // В корректной позиции этого не должно происходить
 }
 
 void Board::reset_highlighted_squares() { clear_highlights(); }
@@ -1,71 +1,166 @@
 #pragma once
 
+#include "board/move.hpp"
 #include "pieces/piece.hpp"
 #include <array>
-#include <deque>
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace chess {
 
-using Position = std::pair<int, int>;
-
 namespace BoardInitializer {
 extern const char *STANDARD_FEN;
 }
 
+class PositionHistory;
+
+// A position and nothing else: squares, side to move, rights, clocks and
+// the incremental sums. It is trivially copyable and 96 bytes, so a copy
+// is a plain memcpy; the keys of earlier positions live in a
+// PositionHistory kept beside it.
 class Board {
   public:
+    // The data members are declared in an order that needs no padding
+    std::uint16_t halfmove_clock_ = 0;
+    std::uint16_t fullmove_number_ = 1;
     Color current_player = Color::WHITE;
+    struct CastlingRights {
+        bool white_kingside = true;
+        bool white_queenside = true;
+        bool black_kingside = true;
+        bool black_queenside = true;
+    } castling_rights_;
+
     explicit Board(const std::string &fen = BoardInitializer::STANDARD_FEN);
 
     // Game operations
+    // Checks the move with is_legal and plays it; false leaves the board
+    // unchanged
     bool make_move(std::pair<int, int> from, std::pair<int, int> to,
                    PieceType promotion = PieceType::NONE);
+    // Plays a move without checking it, so it must be legal here: one from
+    // our own generator or one that passed is_legal. Castling, en passant
+    // and promotion are recognised from the squares.
+    void apply_move(const Move &move);
     std::vector<std::pair<int, int>>
     get_legal_moves(std::pair<int, int> position) const;
-    void print(bool show_highlights = false) const;
+    // Checks one move without generating the others: the piece pattern
+    // and the squares it crosses, then whether the own king is left
+    // attacked. Meant for moves from outside (UCI, GUI, terminal).
+    bool is_legal(const Move &move) const;
+    // The pattern part only, for moves remembered by the search (TT
+    // moves) that may belong to another position
+    bool is_pseudo_legal(const Move &move) const;
+    void print(bool show_highlights = false,
+               PieceSet set = PieceSet::UNICODE) const;
 
     // State queries
     bool is_check(Color player) const;
     bool is_checkmate(Color player);
     bool is_stalemate(Color player);
+    bool has_legal_move(Color player) const;
+    // Stalemate, insufficient material or the fifty-move rule; with the
+    // game's history, threefold repetition as well
     bool is_draw() const;
+    bool is_draw(const PositionHistory &history) const;
+    // Draws the search can see without generating moves: fifty-move rule,
+    // any repetition since the last irreversible move and insufficient
+    // material. Stalemate shows up as an empty move list instead.
+    bool is_search_draw(const PositionHistory &history) const;
     bool is_attacked(std::pair<int, int> square, Color by_color) const;
     bool is_empty(std::pair<int, int> square) const;
     bool is_enemy(std::pair<int, int> square, Color ally_color) const;
 
-    std::optional<std::pair<int, int>> en_passant_target_;
-    int halfmove_clock_ = 0;
-    int fullmove_number_ = 1;
-
     // Accessors
-    const Piece &get_piece(std::pair<int, int> square) const {
-        return grid_[square.second][square.first];
+    Piece get_piece(std::pair<int, int> square) const {
+        return Piece::from_code(piece_codes_[square.second * 8 + square.first]);
+    }
+
+    // The square behind a pawn that has just advanced two squares
+    std::optional<Position> en_passant_target() const {
+        if (en_passant_square_ < 0)
+            return std::nullopt;
+        return Position{en_passant_square_ % 8, en_passant_square_ / 8};
+    }
+    void set_en_passant_target(std::optional<Position> square) {
+        en_passant_square_ = static_cast<std::int8_t>(
+            square ? square->second * 8 + square->first : -1);
     }
-    PieceSet get_piece_set() const { return piece_set_; }
-    void set_piece_set(PieceSet set) { piece_set_ = set; }
 
-    Position find_king(Color color) const;
+    // {-1, -1} when the side has no king
+    Position find_king(Color color) const {
+        const int square = king_squares_[color_index(color)];
+        return square < 0 ? Position{-1, -1} : Position{square % 8, square / 8};
+    }
+
+    // Zobrist key of the position, equal to zobrist::hash(*this). The piece
+    // part is updated in set_piece, the rest is a few table lookups.
+    std::uint64_t hash() const;
+
+    // Every write to a square goes through here so the incremental
+    // counters below stay in sync with the squares.
+    void set_piece(std::pair<int, int> square, const Piece &piece);
+
+    // Incrementally maintained material and piece-square sums. Counts of
+    // pawns to queens come from the material key, kings from their squares.
+    int piece_count(Color color, PieceType type) const {
+        if (type == PieceType::KING)
+            return king_squares_[color_index(color)] < 0 ? 0 : 1;
+        if (type < PieceType::PAWN || type > PieceType::QUEEN)
+            return 0;
+        return static_cast<int>(
+            (material_key_ >> material_shift(color, type)) & 0xF);
+    }
+    int psq_score(Color color, bool endgame) const;
+
+    // Material signature: four bits per (colour, P/N/B/R/Q) count, white
+    // first, followed by four bits per colour counting light-squared bishops.
+    // Kings are not part of the key.
+    static constexpr int LIGHT_BISHOP_SHIFT = 40;
+    static constexpr std::uint64_t MATERIAL_COUNTS_MASK =
+        (1ULL << LIGHT_BISHOP_SHIFT) - 1;
+    static constexpr int material_shift(Color color, PieceType type) {
+        return (color_index(color) * 5 + static_cast<int>(type) - 1) * 4;
+    }
+    static constexpr std::uint64_t material_side_mask(Color color) {
+        return ((1ULL << 20) - 1) << material_shift(color, PieceType::PAWN);
+    }
+    std::uint64_t material_key() const { return material_key_; }
+    int light_bishops(Color color) const {
+        return static_cast<int>(
+            (material_key_ >> (LIGHT_BISHOP_SHIFT + 4 * color_index(color))) &
+            0xF);
+    }
+
+    // The squares themselves: one Piece::code() per square, index y * 8 + x
+    static constexpr std::uint8_t BLACK_CODE = Piece::BLACK;
+    const std::array<std::uint8_t, 64> &piece_codes() const {
+        return piece_codes_;
+    }
 
     void highlight_moves(const std::vector<std::pair<int, int>> &moves);
     void clear_highlights();
 
-    struct CastlingRights {
-        bool white_kingside = true;
-        bool white_queenside = true;
-        bool black_kingside = true;
-        bool black_queenside = true;
-    } castling_rights_;
-    std::array<std::array<Piece, 8>, 8> grid_;
-
   private:
-    PieceSet piece_set_ = PieceSet::UNICODE;
-    std::deque<std::string> position_history_; // For repetition detection
+    std::int8_t en_passant_square_ = -1;
+    std::array<std::int8_t, 2> king_squares_{-1, -1};
+    // Middlegame tables; the endgame sum differs only by the king's entry
+    std::array<std::int16_t, 2> psq_middlegame_{};
+    std::array<std::uint8_t, 64> piece_codes_{};
+    std::uint64_t material_key_ = 0;
+    std::uint64_t piece_key_ = 0;
+
+    static constexpr int color_index(Color color) {
+        return color == Color::WHITE ? 0 : 1;
+    }
+    void update_scores(std::pair<int, int> square, const Piece &piece,
+                       int sign);
 
     void reset_highlighted_squares();
-    void add_position_to_history();
 
     bool in_bounds(int x, int y) const {
         return x >= 0 && x < 8 && y >= 0 && y < 8;
@@ -76,4 +171,8 @@ class Board {
     friend class CheckValidator;
     friend class DrawRules;
 };
+
+static_assert(std::is_trivially_copyable_v<Board>);
+static_assert(sizeof(Board) <= 96);
+
 } // namespace chess
@@ -4,14 +4,24 @@
 namespace chess {
 class CastlingManager {
   public:
-    static bool try_perform_castle(Board &board, std::pair<int, int> king_from,
-                                   std::pair<int, int> king_to);
-
+    // Drops the rights lost by a king or rook leaving `square`, or by a
+    // rook being captured there. Called before the move is made.
     static void update_castling_rights(Board &board,
-                                       std::pair<int, int> moved_from);
+                                       std::pair<int, int> square);
 
+    // The full rule: right, pieces in place, empty path and the king
+    // neither in check nor passing or landing on an attacked square
     static bool can_castle_kingside(const Board &board, Color color);
 
     static bool can_castle_queenside(const Board &board, Color color);
+
+    // Right, king and rook on their home squares and nothing between them;
+    // attacks are not looked at
+    static bool is_castle_pseudo_legal(const Board &board, Color color,
+                                       bool kingside);
+
+    static std::pair<int, int> king_home(Color color) {
+        return {4, color == Color::WHITE ? 7 : 0};
+    }
 };
 } // namespace chess
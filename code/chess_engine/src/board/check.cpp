@@ -1,101 +1,115 @@
 #include "board/check.hpp"
+#include "board/geometry.hpp"
 #include "board/move_generation.hpp"
-#include <algorithm>
 
 namespace chess {
+namespace {
 
-bool CheckValidator::is_check(const Board &board, Color player) {
-    // Find king position
-    std::pair<int, int> king_pos = {-1, -1};
-    for (int y = 0; y < 8 && king_pos.first == -1; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            const auto &piece = board.grid_[y][x];
-            if (piece.get_type() == PieceType::KING &&
-                piece.get_color() == player) {
-                king_pos = {x, y};
-                break;
-            }
-        }
-    }
+using namespace geometry;
+
+constexpr std::uint8_t code_of(PieceType type, Color color) {
+    return static_cast<std::uint8_t>(
+        static_cast<int>(type) |
+        (color == Color::BLACK ? Board::BLACK_CODE : 0));
+}
+
+// Highlight markers only decorate the board and block nothing
+constexpr bool is_empty_code(std::uint8_t code) {
+    return code == 0 ||
+           (code & 7) == static_cast<std::uint8_t>(PieceType::HIGHLIGHT);
+}
+
+} // namespace
 
+bool CheckValidator::is_check(const Board &board, Color player) {
+    const auto king_pos = board.find_king(player);
     if (king_pos.first == -1)
         return false;
-    return is_attacked(board, king_pos,
+    return is_attacked(board.piece_codes_, king_pos,
                        player == Color::WHITE ? Color::BLACK : Color::WHITE);
 }
 
 bool CheckValidator::is_checkmate(Board &board, Color player) {
-    if (!is_check(board, player))
-        return false;
+    return is_check(board, player) && !has_legal_move(board, player);
+}
+
+bool CheckValidator::is_stalemate(Board &board, Color player) {
+    // Пат: нет шаха и нет легальных ходов
+    return !is_check(board, player) && !has_legal_move(board, player);
+}
+
+bool CheckValidator::has_legal_move(const Board &board, Color player) {
+    // In check the king is the likeliest piece to have a move
+    const Position king = board.find_king(player);
+    if (king.first != -1 && MoveGenerator::has_legal_move(board, king))
+        return true;
 
-    // Check if any move can get out of check
     for (int y = 0; y < 8; ++y) {
         for (int x = 0; x < 8; ++x) {
-            const auto &piece = board.grid_[y][x];
+            const Piece piece = board.get_piece({x, y});
             if (piece.get_type() != PieceType::NONE &&
-                piece.get_color() == player) {
-                auto moves =
-                    MoveGenerator::generate_pseudo_legal_moves(board, {x, y});
-                for (const auto &move : moves) {
-                    Board temp = board;
-                    if (temp.make_move({x, y}, move)) {
-                        if (!CheckValidator::is_check(temp, player)) {
-                            return false;
-                        }
-                    }
-                }
+                piece.get_type() != PieceType::KING &&
+                piece.get_color() == player &&
+                MoveGenerator::has_legal_move(board, {x, y})) {
+                return true;
             }
         }
     }
+    return false;
+}
 
-    return true;
+bool CheckValidator::is_attacked(const Board &board, std::pair<int, int> square,
+                                 Color by_color) {
+    return is_attacked(board.piece_codes_, square, by_color);
 }
 
-bool CheckValidator::is_stalemate(Board &board, Color player) {
-    // Условия пата:
-    // 1. Нет шаха
-    // 2. Нет легальных ходов
-    if (is_check(board, player)) {
-        return false;
+std::pair<int, int> CheckValidator::find_king(const Codes &codes,
+                                              Color color) {
+    const auto king = code_of(PieceType::KING, color);
+    for (int i = 0; i < 64; ++i) {
+        if (codes[i] == king)
+            return {i % 8, i / 8};
     }
+    return {-1, -1};
+}
 
-    // Проверяем все возможные ходы
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            const auto &piece = board.grid_[y][x];
-            if (piece.get_type() != PieceType::NONE && 
-                piece.get_color() == player) {
-                
-                auto moves = MoveGenerator::get_legal_moves(board, {x, y});
-                if (!moves.empty()) {
-                    return false;  // Нашли хотя бы один легальный ход
-                }
-            }
+bool CheckValidator::is_attacked(const Codes &codes, std::pair<int, int> square,
+                                 Color by_color) {
+    const int target = square_of(square.first, square.second);
+    const auto contains = [&codes](SquareSet squares, std::uint8_t code) {
+        while (squares) {
+            if (codes[pop_square(squares)] == code)
+                return true;
         }
-    }
+        return false;
+    };
 
-    return true;  // Нет легальных ходов - пат
-}
+    // Pawns that attack the square stand where a pawn of the other colour
+    // on it would attack
+    const int pawn_side = by_color == Color::WHITE ? 1 : 0;
+    if (contains(PAWN_ATTACKS[pawn_side][target],
+                 code_of(PieceType::PAWN, by_color)) ||
+        contains(KNIGHT_ATTACKS[target],
+                 code_of(PieceType::KNIGHT, by_color)) ||
+        contains(KING_ATTACKS[target], code_of(PieceType::KING, by_color)))
+        return true;
 
-bool CheckValidator::is_attacked(const Board &board, std::pair<int, int> square,
-                                 Color by_color) {
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            // Используйте get_piece вместо прямого доступа к grid_
-            const auto &piece = board.get_piece({x, y});
-            if (piece.get_type() != PieceType::NONE &&
-                piece.get_color() == by_color) {
-                auto moves =
-                    MoveGenerator::generate_pseudo_legal_moves(board, {x, y});
-                auto it = std::find_if(
-                    moves.begin(), moves.end(),
-                    [&square](const auto &move) { return move == square; });
-                if (it != moves.end()) {
-                    return true;
-                }
-            }
+    const auto queen = code_of(PieceType::QUEEN, by_color);
+    for (int d = 0; d < DIRECTION_COUNT; ++d) {
+        const auto slider = code_of(
+            is_straight(d) ? PieceType::ROOK : PieceType::BISHOP, by_color);
+        int s = target;
+        for (int i = RAY_LENGTH[d][target]; i > 0; --i) {
+            s += DIRECTION_STEP[d];
+            const auto code = codes[s];
+            if (is_empty_code(code))
+                continue;
+            if (code == slider || code == queen)
+                return true;
+            break;
         }
     }
     return false;
 }
+
 } // namespace chess
@@ -1,5 +1,7 @@
 #pragma once
 #include "board/board.hpp"
+#include <array>
+#include <cstdint>
 
 namespace chess {
 class CheckValidator {
@@ -10,7 +12,19 @@ class CheckValidator {
     
     static bool is_stalemate(Board &board, Color player);
 
+    // Early exit on the first legal move found, king first
+    static bool has_legal_move(const Board &board, Color player);
+
     static bool is_attacked(const Board &board, std::pair<int, int> square,
                             Color by_color);
+
+    // Same test on a bare mailbox laid out like Board::piece_codes(), so a
+    // move can be tried on a 64-byte copy instead of a whole board
+    using Codes = std::array<std::uint8_t, 64>;
+    static bool is_attacked(const Codes &codes, std::pair<int, int> square,
+                            Color by_color);
+
+    // Square of the king of `color` in `codes`, {-1, -1} if there is none
+    static std::pair<int, int> find_king(const Codes &codes, Color color);
 };
 } // namespace chess
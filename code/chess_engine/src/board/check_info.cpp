@@ -0,0 +1,126 @@
+#include "board/check_info.hpp"
+#include "board/check.hpp"
+#include "board/geometry.hpp"
+#include <cstdlib>
+
+namespace chess {
+namespace {
+
+using namespace geometry;
+
+constexpr int type_of(std::uint8_t code) { return code & 7; }
+
+constexpr bool is_empty_code(std::uint8_t code) {
+    return code == 0 ||
+           type_of(code) == static_cast<int>(PieceType::HIGHLIGHT);
+}
+
+constexpr Color color_of(std::uint8_t code) {
+    return (code & Board::BLACK_CODE) ? Color::BLACK : Color::WHITE;
+}
+
+} // namespace
+
+CheckInfo::CheckInfo(const Board &board) : color_(board.current_player) {
+    const Color enemy =
+        color_ == Color::WHITE ? Color::BLACK : Color::WHITE;
+    const auto &codes = board.piece_codes();
+    enemy_king_ = CheckValidator::find_king(codes, enemy);
+    if (enemy_king_.first == -1)
+        return;
+    const int king = square_of(enemy_king_.first, enemy_king_.second);
+
+    // Own pawns check from where an enemy pawn on the king's square would
+    // attack
+    check_squares_[static_cast<int>(PieceType::PAWN)] =
+        PAWN_ATTACKS[color_ == Color::WHITE ? 1 : 0][king];
+    check_squares_[static_cast<int>(PieceType::KNIGHT)] = KNIGHT_ATTACKS[king];
+
+    for (int d = 0; d < DIRECTION_COUNT; ++d) {
+        const int slider_index = static_cast<int>(
+            is_straight(d) ? PieceType::ROOK : PieceType::BISHOP);
+        int s = king;
+        int left = RAY_LENGTH[d][king];
+        // Squares up to and including the first piece
+        for (; left > 0; --left) {
+            s += DIRECTION_STEP[d];
+            check_squares_[slider_index] |= square_bit(s);
+            if (!is_empty_code(codes[s]))
+                break;
+        }
+        if (left == 0)
+            continue;
+
+        // An own piece there is a discoverer if an own slider of the
+        // right kind stands behind it
+        const int blocker = s;
+        if (color_of(codes[blocker]) != color_)
+            continue;
+        for (--left; left > 0; --left) {
+            s += DIRECTION_STEP[d];
+            const std::uint8_t code = codes[s];
+            if (is_empty_code(code))
+                continue;
+            if (color_of(code) == color_ &&
+                (type_of(code) == slider_index ||
+                 type_of(code) == static_cast<int>(PieceType::QUEEN)))
+                discoverers_ |= square_bit(blocker);
+            break;
+        }
+    }
+    check_squares_[static_cast<int>(PieceType::QUEEN)] =
+        check_squares_[static_cast<int>(PieceType::ROOK)] |
+        check_squares_[static_cast<int>(PieceType::BISHOP)];
+}
+
+bool CheckInfo::gives_check(const Board &board, const Move &move) const {
+    if (enemy_king_.first == -1)
+        return false;
+    const auto [from, to] = std::make_pair(move.from, move.to);
+    const auto &codes = board.piece_codes();
+    const std::uint8_t moving = codes[from.second * 8 + from.first];
+    const auto type = static_cast<PieceType>(type_of(moving));
+
+    const bool en_passant = type == PieceType::PAWN &&
+                            from.first != to.first &&
+                            is_empty_code(codes[to.second * 8 + to.first]);
+    const bool castling =
+        type == PieceType::KING && std::abs(to.first - from.first) == 2;
+    const bool promotion =
+        type == PieceType::PAWN && (to.second == 0 || to.second == 7);
+    if (!en_passant && !castling && !promotion) {
+        const int from_square = square_of(from.first, from.second);
+        const int to_square = square_of(to.first, to.second);
+        if (check_squares_[static_cast<int>(type)] & square_bit(to_square))
+            return true;
+        // No piece can jump over the king along the line, so staying on
+        // it keeps the slider blocked
+        const int king = square_of(enemy_king_.first, enemy_king_.second);
+        return (discoverers_ & square_bit(from_square)) &&
+               !(LINE[king][from_square] & square_bit(to_square));
+    }
+
+    // Rare moves that change more than two squares: play them on a copy
+    CheckValidator::Codes after = codes;
+    std::uint8_t placed = moving;
+    if (promotion) {
+        const auto promoted = move.promotion == PieceType::NONE
+                                  ? PieceType::QUEEN
+                                  : move.promotion;
+        placed = static_cast<std::uint8_t>((moving & Board::BLACK_CODE) |
+                                           static_cast<int>(promoted));
+    }
+    if (en_passant)
+        after[from.second * 8 + to.first] = 0;
+    if (castling) {
+        const int rook_x = to.first > from.first ? 7 : 0;
+        const int rook_to = (from.first + to.first) / 2;
+        after[from.second * 8 + rook_to] = after[from.second * 8 + rook_x];
+        after[from.second * 8 + rook_x] = 0;
+    }
+    after[from.second * 8 + from.first] = 0;
+    after[to.second * 8 + to.first] = placed;
+    return CheckValidator::is_attacked(after, enemy_king_, color_);
+}
+
+} // namespace chess
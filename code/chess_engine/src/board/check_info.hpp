@@ -0,0 +1,36 @@
+#pragma once
+#include "board/board.hpp"
+#include <array>
+#include <cstdint>
+
+namespace chess {
+
+// Check data of one position, computed once per node for the side to move
+// so that gives_check needs no move to be made. Square sets are bit masks
+// over the mailbox index y * 8 + x.
+class CheckInfo {
+  public:
+    explicit CheckInfo(const Board &board);
+
+    // Whether the move, legal in the board passed to the constructor, puts
+    // the enemy king in check. Castling, en passant and promotions take a
+    // slower path on a copy of the mailbox; the rest is a few bit tests.
+    bool gives_check(const Board &board, const Move &move) const;
+
+    // Squares from which a piece of the side to move, indexed by PieceType,
+    // would attack the enemy king
+    std::uint64_t check_squares(PieceType type) const {
+        return check_squares_[static_cast<int>(type)];
+    }
+    // Own pieces standing between an own slider and the enemy king: moving
+    // one off that line is a discovered check
+    std::uint64_t discoverers() const { return discoverers_; }
+
+  private:
+    Color color_;
+    Position enemy_king_{-1, -1};
+    std::array<std::uint64_t, 8> check_squares_{};
+    std::uint64_t discoverers_ = 0;
+};
+
+} // namespace chess
@@ -0,0 +1,184 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Board geometry tables. Squares are mailbox indices y * 8 + x as in
+// Board::piece_codes() (y = 0 is rank 8) and a set of squares is a 64-bit
+// mask over them. Every table is built by the compiler, so nothing runs at
+// startup and lookups need no bounds checks.
+namespace chess::geometry {
+
+using SquareSet = std::uint64_t;
+
+constexpr int square_of(int x, int y) { return y * 8 + x; }
+constexpr int file_of(int square) { return square & 7; }
+constexpr int row_of(int square) { return square >> 3; }
+constexpr SquareSet square_bit(int square) { return 1ULL << square; }
+
+// Ray directions, the four straight ones first. Opposite directions are
+// neighbours: d ^ 1 reverses d.
+constexpr int DIRECTION_COUNT = 8;
+constexpr int DIRECTION_X[DIRECTION_COUNT] = {1, -1, 0, 0, 1, -1, 1, -1};
+constexpr int DIRECTION_Y[DIRECTION_COUNT] = {0, 0, 1, -1, 1, -1, -1, 1};
+// Index offset of one step in each direction
+constexpr int DIRECTION_STEP[DIRECTION_COUNT] = {1, -1, 8, -8, 9, -9, -7, 7};
+
+constexpr bool is_straight(int direction) { return direction < 4; }
+
+// Lowest square of a non-empty set, which is removed from it
+inline int pop_square(SquareSet &set) {
+    const int square = __builtin_ctzll(set);
+    set &= set - 1;
+    return square;
+}
+
+namespace detail {
+
+constexpr bool on_board(int x, int y) {
+    return x >= 0 && x < 8 && y >= 0 && y < 8;
+}
+
+constexpr int abs(int value) { return value < 0 ? -value : value; }
+constexpr int max(int a, int b) { return a < b ? b : a; }
+
+template <int N>
+constexpr std::array<SquareSet, 64> leaper_attacks(const int (&dx)[N],
+                                                   const int (&dy)[N]) {
+    std::array<SquareSet, 64> table{};
+    for (int square = 0; square < 64; ++square) {
+        for (int i = 0; i < N; ++i) {
+            const int x = file_of(square) + dx[i];
+            const int y = row_of(square) + dy[i];
+            if (on_board(x, y))
+                table[square] |= square_bit(square_of(x, y));
+        }
+    }
+    return table;
+}
+
+constexpr int KNIGHT_X[8] = {1, 2, 2, 1, -1, -2, -2, -1};
+constexpr int KNIGHT_Y[8] = {2, 1, -1, -2, -2, -1, 1, 2};
+constexpr int WHITE_PAWN_X[2] = {-1, 1};
+constexpr int WHITE_PAWN_Y[2] = {-1, -1};
+constexpr int BLACK_PAWN_X[2] = {-1, 1};
+constexpr int BLACK_PAWN_Y[2] = {1, 1};
+
+constexpr std::array<std::array<std::uint8_t, 64>, DIRECTION_COUNT>
+make_ray_lengths() {
+    std::array<std::array<std::uint8_t, 64>, DIRECTION_COUNT> table{};
+    for (int d = 0; d < DIRECTION_COUNT; ++d) {
+        for (int square = 0; square < 64; ++square) {
+            int x = file_of(square) + DIRECTION_X[d];
+            int y = row_of(square) + DIRECTION_Y[d];
+            std::uint8_t length = 0;
+            for (; on_board(x, y); x += DIRECTION_X[d], y += DIRECTION_Y[d])
+                ++length;
+            table[d][square] = length;
+        }
+    }
+    return table;
+}
+
+constexpr std::array<std::array<SquareSet, 64>, DIRECTION_COUNT> make_rays() {
+    std::array<std::array<SquareSet, 64>, DIRECTION_COUNT> table{};
+    for (int d = 0; d < DIRECTION_COUNT; ++d) {
+        for (int square = 0; square < 64; ++square) {
+            int x = file_of(square) + DIRECTION_X[d];
+            int y = row_of(square) + DIRECTION_Y[d];
+            for (; on_board(x, y); x += DIRECTION_X[d], y += DIRECTION_Y[d])
+                table[d][square] |= square_bit(square_of(x, y));
+        }
+    }
+    return table;
+}
+
+// Direction from a to b when they share a line, -1 otherwise
+constexpr int direction_between(int a, int b) {
+    const int dx = file_of(b) - file_of(a);
+    const int dy = row_of(b) - row_of(a);
+    if (a == b || (dx != 0 && dy != 0 && abs(dx) != abs(dy)))
+        return -1;
+    const int sx = (dx > 0) - (dx < 0);
+    const int sy = (dy > 0) - (dy < 0);
+    for (int d = 0; d < DIRECTION_COUNT; ++d) {
+        if (DIRECTION_X[d] == sx && DIRECTION_Y[d] == sy)
+            return d;
+    }
+    return -1;
+}
+
+constexpr std::array<std::array<std::int8_t, 64>, 64> make_directions() {
+    std::array<std::array<std::int8_t, 64>, 64> table{};
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b)
+            table[a][b] = static_cast<std::int8_t>(direction_between(a, b));
+    }
+    return table;
+}
+
+constexpr std::array<std::array<SquareSet, 64>, 64> make_between() {
+    std::array<std::array<SquareSet, 64>, 64> table{};
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            const int d = direction_between(a, b);
+            if (d < 0)
+                continue;
+            for (int s = a + DIRECTION_STEP[d]; s != b; s += DIRECTION_STEP[d])
+                table[a][b] |= square_bit(s);
+        }
+    }
+    return table;
+}
+
+constexpr std::array<std::array<SquareSet, 64>, 64> make_lines() {
+    const auto rays = make_rays();
+    std::array<std::array<SquareSet, 64>, 64> table{};
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            const int d = direction_between(a, b);
+            if (d < 0)
+                continue;
+            table[a][b] = rays[d][a] | rays[d ^ 1][a] | square_bit(a);
+        }
+    }
+    return table;
+}
+
+constexpr std::array<std::array<std::uint8_t, 64>, 64> make_distances() {
+    std::array<std::array<std::uint8_t, 64>, 64> table{};
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            table[a][b] = static_cast<std::uint8_t>(
+                max(abs(file_of(a) - file_of(b)), abs(row_of(a) - row_of(b))));
+        }
+    }
+    return table;
+}
+
+} // namespace detail
+
+inline constexpr auto KNIGHT_ATTACKS =
+    detail::leaper_attacks(detail::KNIGHT_X, detail::KNIGHT_Y);
+inline constexpr auto KING_ATTACKS = detail::leaper_attacks(
+    DIRECTION_X, DIRECTION_Y);
+// Squares a pawn on the square attacks, white first. A white pawn moves
+// towards y = 0.
+inline constexpr std::array<std::array<SquareSet, 64>, 2> PAWN_ATTACKS = {
+    detail::leaper_attacks(detail::WHITE_PAWN_X, detail::WHITE_PAWN_Y),
+    detail::leaper_attacks(detail::BLACK_PAWN_X, detail::BLACK_PAWN_Y)};
+
+// Squares from a square to the edge in each direction, and their count
+inline constexpr auto RAYS = detail::make_rays();
+inline constexpr auto RAY_LENGTH = detail::make_ray_lengths();
+
+// Direction from the first square to the second, -1 if they are not on a
+// common line
+inline constexpr auto DIRECTION = detail::make_directions();
+// Squares strictly between two squares on a common line, else empty
+inline constexpr auto BETWEEN = detail::make_between();
+// The whole line through two squares, edge to edge, else empty
+inline constexpr auto LINE = detail::make_lines();
+// King moves from one square to the other
+inline constexpr auto DISTANCE = detail::make_distances();
+
+} // namespace chess::geometry
@@ -1,8 +1,8 @@
 #include "board/initialization.hpp"
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <optional>
-#include <sstream>
 #include <stdexcept>
 
 namespace chess {
@@ -76,265 +76,290 @@ void clear_board(Board &board) {
     // Очищаем все клетки доски
     for (int rank = 0; rank < 8; ++rank) {
         for (int file = 0; file < 8; ++file) {
-            board.grid_[rank][file] = Piece(PieceType::NONE, Color::WHITE);
+            board.set_piece({file, rank}, Piece(PieceType::NONE, Color::WHITE));
         }
     }
 
     // Сбрасываем все дополнительные параметры
     board.current_player = Color::WHITE;
     board.castling_rights_ = Board::CastlingRights{};
-    board.en_passant_target_ = std::nullopt;
+    board.set_en_passant_target(std::nullopt);
     board.halfmove_clock_ = 0;
     board.fullmove_number_ = 1;
 }
 
-void setup_initial_position(Board &board, const std::string &fen) {
-    clear_board(board);
-    std::istringstream fen_stream(fen);
-    std::string part;
+namespace {
 
-    // 1. Piece placement
-    if (!std::getline(fen_stream, part, ' ')) {
-        throw std::invalid_argument("Invalid FEN: missing piece placement");
-    }
-    detail::parse_piece_placement(board, part);
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
 
-    // 2. Active color
-    if (!std::getline(fen_stream, part, ' ')) {
-        throw std::invalid_argument("Invalid FEN: missing active color");
+bool is_piece_char(char c) {
+    switch (c) {
+        case 'p': case 'n': case 'b': case 'r': case 'q': case 'k':
+        case 'P': case 'N': case 'B': case 'R': case 'Q': case 'K':
+            return true;
+        default:
+            return false;
     }
-    detail::parse_active_color(board, part);
+}
 
-    // 3. Castling availability
-    if (!std::getline(fen_stream, part, ' ')) {
-        throw std::invalid_argument("Invalid FEN: missing castling rights");
-    }
-    detail::parse_castling_rights(board, part);
+// Skips the whitespace before the next field; false if there is none
+bool next_field(std::string_view fen, std::size_t &i) {
+    const std::size_t start = i;
+    while (i < fen.size() && is_space(fen[i]))
+        ++i;
+    return i > start && i < fen.size();
+}
 
-    // 4. En passant
-    if (!std::getline(fen_stream, part, ' ')) {
-        throw std::invalid_argument("Invalid FEN: missing en passant");
-    }
-    detail::parse_en_passant(board, part);
+std::size_t field_end(std::string_view fen, std::size_t i) {
+    while (i < fen.size() && !is_space(fen[i]))
+        ++i;
+    return i;
+}
 
-    // 5. Halfmove clock
-    if (!std::getline(fen_stream, part, ' ')) {
-        throw std::invalid_argument("Invalid FEN: missing halfmove clock");
+// The board keeps both move counters in 16 bits
+constexpr int MAX_COUNTER = 0xFFFF;
+
+// Non-negative decimal of at most nine digits, so it fits an int
+bool parse_number(std::string_view text, int &value) {
+    if (text.empty() || text.size() > 9)
+        return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9')
+            return false;
+        value = value * 10 + (c - '0');
     }
-    detail::parse_halfmove_clock(board, part);
+    return true;
+}
 
-    // 6. Fullmove number
-    if (std::getline(fen_stream, part, ' ')) {
-        detail::parse_fullmove_number(board, part);
-    }
+char *write_number(char *out, int value) {
+    return std::to_chars(out, out + 11, value).ptr;
 }
 
-void detail::parse_piece_placement(Board &board, const std::string &fen_part) {
+} // namespace
+
+FenError::FenError(const FenParseError &error)
+    : std::invalid_argument("Invalid FEN at offset " +
+                            std::to_string(error.offset) + ": " +
+                            error.message),
+      offset_(error.offset) {}
+
+std::optional<FenParseError> try_setup_position(Board &board,
+                                                std::string_view fen) {
+    std::size_t i = 0;
+    while (i < fen.size() && is_space(fen[i]))
+        ++i;
+
+    // 1. Piece placement, checked in full before the board is touched
+    std::array<char, 64> squares{};
+    std::array<int, 2> kings{};
     int rank = 0;
     int file = 0;
-
-    for (char c : fen_part) {
+    bool after_digit = false;
+    for (; i < fen.size() && !is_space(fen[i]); ++i) {
+        const char c = fen[i];
         if (c == '/') {
-            if (file != 8) {
-                throw std::invalid_argument(
-                    "Invalid FEN: incomplete rank in piece placement");
-            }
-            rank++;
+            if (file != 8)
+                return FenParseError{i, "incomplete rank in piece placement"};
+            if (++rank == 8)
+                return FenParseError{i, "more than eight ranks"};
             file = 0;
-            if (rank >= 8)
-                break;
-        } else if (isdigit(c)) {
-            int spaces = c - '0';
-            if (spaces < 1 || spaces > 8) {
-                throw std::invalid_argument(
-                    "Invalid FEN: invalid number in piece placement");
-            }
-            file += spaces;
-            if (file > 8) {
-                throw std::invalid_argument(
-                    "Invalid FEN: too many squares in rank");
-            }
+            after_digit = false;
+        } else if (c >= '1' && c <= '8') {
+            if (after_digit)
+                return FenParseError{i, "two digits in a row"};
+            file += c - '0';
+            if (file > 8)
+                return FenParseError{i, "too many squares in rank"};
+            after_digit = true;
+        } else if (is_piece_char(c)) {
+            if (file == 8)
+                return FenParseError{i, "too many squares in rank"};
+            if ((c == 'P' || c == 'p') && (rank == 0 || rank == 7))
+                return FenParseError{i, "pawn on the first or last rank"};
+            if ((c == 'K' || c == 'k') && ++kings[c == 'k'] > 1)
+                return FenParseError{i, "more than one king of a colour"};
+            squares[rank * 8 + file++] = c;
+            after_digit = false;
         } else {
-            if (file >= 8) {
-                throw std::invalid_argument(
-                    "Invalid FEN: too many pieces in rank");
-            }
-            board.grid_[rank][file] = detail::char_to_piece(c);
-            file++;
+            return FenParseError{i, "invalid piece placement character"};
         }
     }
+    if (rank != 7 || file != 8)
+        return FenParseError{i, "incomplete board"};
 
-    if (rank != 7 || file != 8) {
-        throw std::invalid_argument("Invalid FEN: incomplete board");
-    }
-}
-
-void detail::parse_active_color(Board &board, const std::string &active_color) {
-    if (active_color.size() != 1) {
-        throw std::invalid_argument(
-            "Invalid FEN: active color must be 'w' or 'b'");
-    }
-
-    switch (active_color[0]) {
-        case 'w':
-            board.current_player = Color::WHITE;
-            break;
-        case 'b':
-            board.current_player = Color::BLACK;
-            break;
-        default:
-            throw std::invalid_argument(
-                "Invalid FEN: active color must be 'w' or 'b'");
-    }
-}
-
-void detail::parse_castling_rights(Board &board, const std::string &castling) {
-    board.castling_rights_ = Board::CastlingRights{};
-
-    if (castling == "-") {
-        return;
-    }
-
-    for (char c : castling) {
-        switch (c) {
-            case 'K':
-                board.castling_rights_.white_kingside = true;
-                break;
-            case 'Q':
-                board.castling_rights_.white_queenside = true;
-                break;
-            case 'k':
-                board.castling_rights_.black_kingside = true;
-                break;
-            case 'q':
-                board.castling_rights_.black_queenside = true;
-                break;
-            default:
-                throw std::invalid_argument(
-                    "Invalid FEN: invalid castling right");
+    // 2. Active color
+    if (!next_field(fen, i))
+        return FenParseError{i, "missing active color"};
+    if (field_end(fen, i) != i + 1 || (fen[i] != 'w' && fen[i] != 'b'))
+        return FenParseError{i, "active color must be 'w' or 'b'"};
+    const Color player = fen[i] == 'w' ? Color::WHITE : Color::BLACK;
+    ++i;
+
+    // 3. Castling availability; only the listed rights are granted
+    if (!next_field(fen, i))
+        return FenParseError{i, "missing castling rights"};
+    Board::CastlingRights castling{false, false, false, false};
+    if (fen[i] == '-') {
+        ++i;
+    } else {
+        for (; i < fen.size() && !is_space(fen[i]); ++i) {
+            bool *right = nullptr;
+            switch (fen[i]) {
+                case 'K':
+                    right = &castling.white_kingside;
+                    break;
+                case 'Q':
+                    right = &castling.white_queenside;
+                    break;
+                case 'k':
+                    right = &castling.black_kingside;
+                    break;
+                case 'q':
+                    right = &castling.black_queenside;
+                    break;
+                default:
+                    return FenParseError{i, "invalid castling right"};
+            }
+            if (*right)
+                return FenParseError{i, "repeated castling right"};
+            *right = true;
         }
     }
-}
-
-void detail::parse_en_passant(Board &board, const std::string &en_passant) {
-    if (en_passant == "-") {
-        board.en_passant_target_ = std::nullopt;
-        return;
-    }
-
-    if (en_passant.size() != 2) {
-        throw std::invalid_argument(
-            "Invalid FEN: en passant must be '-' or square coordinate");
+    if (i < fen.size() && !is_space(fen[i]))
+        return FenParseError{i, "invalid castling right"};
+
+    // 4. En passant: the square behind a pawn that has just moved two
+    // squares, so rank 6 with White to move and rank 3 with Black
+    if (!next_field(fen, i))
+        return FenParseError{i, "missing en passant"};
+    std::optional<Position> en_passant;
+    if (fen[i] == '-') {
+        ++i;
+    } else {
+        if (field_end(fen, i) != i + 2 || fen[i] < 'a' || fen[i] > 'h')
+            return FenParseError{i,
+                                 "en passant must be '-' or square coordinate"};
+        const char expected_rank = player == Color::WHITE ? '6' : '3';
+        if (fen[i + 1] != expected_rank)
+            return FenParseError{i + 1, "invalid en passant square"};
+        en_passant = Position{fen[i] - 'a', 8 - (fen[i + 1] - '0')};
+        i += 2;
     }
-
-    int file = tolower(en_passant[0]) - 'a';
-    int rank = 8 - (en_passant[1] - '0');
-
-    if (file < 0 || file >= 8 || rank < 0 || rank >= 8) {
-        throw std::invalid_argument("Invalid FEN: invalid en passant square");
+    if (i < fen.size() && !is_space(fen[i]))
+        return FenParseError{i, "en passant must be '-' or square coordinate"};
+
+    // 5-6. Move counters, optional
+    int halfmove_clock = 0;
+    int fullmove_number = 1;
+    if (next_field(fen, i)) {
+        const std::size_t end = field_end(fen, i);
+        if (!parse_number(fen.substr(i, end - i), halfmove_clock))
+            return FenParseError{i, "halfmove clock must be a number"};
+        if (halfmove_clock > MAX_COUNTER)
+            return FenParseError{i, "halfmove clock is too large"};
+        i = end;
+        if (next_field(fen, i)) {
+            const std::size_t end = field_end(fen, i);
+            if (!parse_number(fen.substr(i, end - i), fullmove_number) ||
+                fullmove_number < 1)
+                return FenParseError{
+                    i, "fullmove number must be a positive integer"};
+            if (fullmove_number > MAX_COUNTER)
+                return FenParseError{i, "fullmove number is too large"};
+            i = end;
+        }
     }
+    while (i < fen.size() && is_space(fen[i]))
+        ++i;
+    if (i != fen.size())
+        return FenParseError{i, "unexpected text after the FEN"};
 
-    board.en_passant_target_ = {file, rank};
-}
-
-void detail::parse_halfmove_clock(Board &board, const std::string &clock) {
-    try {
-        board.halfmove_clock_ = std::stoi(clock);
-        if (board.halfmove_clock_ < 0) {
-            throw std::invalid_argument("Halfmove clock cannot be negative");
-        }
-    } catch (...) {
-        throw std::invalid_argument(
-            "Invalid FEN: halfmove clock must be a number");
+    clear_board(board);
+    for (int square = 0; square < 64; ++square) {
+        if (squares[square])
+            board.set_piece({square % 8, square / 8},
+                            detail::char_to_piece(squares[square]));
     }
+    board.current_player = player;
+    board.castling_rights_ = castling;
+    board.set_en_passant_target(en_passant);
+    board.halfmove_clock_ = halfmove_clock;
+    board.fullmove_number_ = fullmove_number;
+    return std::nullopt;
 }
 
-void detail::parse_fullmove_number(Board &board, const std::string &number) {
-    try {
-        board.fullmove_number_ = std::stoi(number);
-        if (board.fullmove_number_ < 1) {
-            throw std::invalid_argument("Fullmove number must be at least 1");
-        }
-    } catch (...) {
-        throw std::invalid_argument(
-            "Invalid FEN: fullmove number must be a positive integer");
-    }
+void setup_initial_position(Board &board, std::string_view fen) {
+    if (auto error = try_setup_position(board, fen))
+        throw FenError(*error);
 }
 
-std::string export_to_fen(const Board &board) {
-    std::ostringstream fen;
+std::string_view write_fen(const Board &board, FenBuffer &buffer) {
+    char *out = buffer.data();
 
     // 1. Piece placement
     for (int rank = 0; rank < 8; ++rank) {
         int empty_count = 0;
-
         for (int file = 0; file < 8; ++file) {
-            const Piece &piece = board.grid_[rank][file];
-
+            const Piece piece = board.get_piece({file, rank});
             if (piece.get_type() == PieceType::NONE) {
                 empty_count++;
-            } else {
-                if (empty_count > 0) {
-                    fen << empty_count;
-                    empty_count = 0;
-                }
-                fen << detail::piece_to_char(piece);
+                continue;
             }
+            if (empty_count > 0) {
+                *out++ = static_cast<char>('0' + empty_count);
+                empty_count = 0;
+            }
+            *out++ = detail::piece_to_char(piece);
         }
-
-        if (empty_count > 0) {
-            fen << empty_count;
-        }
-
-        if (rank < 7) {
-            fen << '/';
-        }
+        if (empty_count > 0)
+            *out++ = static_cast<char>('0' + empty_count);
+        if (rank < 7)
+            *out++ = '/';
     }
 
     // 2. Active color
-    fen << ' ' << (board.current_player == Color::WHITE ? 'w' : 'b');
+    *out++ = ' ';
+    *out++ = board.current_player == Color::WHITE ? 'w' : 'b';
 
     // 3. Castling rights
-    fen << ' ';
-    bool any_castling = false;
-
-    if (board.castling_rights_.white_kingside) {
-        fen << 'K';
-        any_castling = true;
-    }
-    if (board.castling_rights_.white_queenside) {
-        fen << 'Q';
-        any_castling = true;
-    }
-    if (board.castling_rights_.black_kingside) {
-        fen << 'k';
-        any_castling = true;
-    }
-    if (board.castling_rights_.black_queenside) {
-        fen << 'q';
-        any_castling = true;
-    }
-
-    if (!any_castling)
-        fen << '-';
+    *out++ = ' ';
+    const char *castling_start = out;
+    if (board.castling_rights_.white_kingside)
+        *out++ = 'K';
+    if (board.castling_rights_.white_queenside)
+        *out++ = 'Q';
+    if (board.castling_rights_.black_kingside)
+        *out++ = 'k';
+    if (board.castling_rights_.black_queenside)
+        *out++ = 'q';
+    if (out == castling_start)
+        *out++ = '-';
 
     // 4. En passant
-    fen << ' ';
-    if (board.en_passant_target_) {
-        char file = 'a' + board.en_passant_target_->first;
-        char rank = '8' - board.en_passant_target_->second;
-        fen << file << rank;
+    *out++ = ' ';
+    if (const auto en_passant = board.en_passant_target()) {
+        *out++ = static_cast<char>('a' + en_passant->first);
+        *out++ = static_cast<char>('8' - en_passant->second);
     } else {
-        fen << '-';
+        *out++ = '-';
     }
 
-    // 5. Halfmove clock
-    fen << ' ' << board.halfmove_clock_;
+    // 5-6. Halfmove clock and fullmove number
+    *out++ = ' ';
+    out = write_number(out, board.halfmove_clock_);
+    *out++ = ' ';
+    out = write_number(out, board.fullmove_number_);
 
-    // 6. Fullmove number
-    fen << ' ' << board.fullmove_number_;
+    *out = '\0';
+    return {buffer.data(), static_cast<std::size_t>(out - buffer.data())};
+}
 
-    return fen.str();
+std::string export_to_fen(const Board &board) {
+    FenBuffer buffer;
+    return std::string(write_fen(board, buffer));
 }
 
 } // namespace BoardInitializer
@@ -1,7 +1,12 @@
 #pragma once
 #include "board/board.hpp"
 #include "pieces/piece.hpp"
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace chess {
 
@@ -10,17 +15,41 @@ extern const char *STANDARD_FEN;
 extern const char *EMPTY_FEN;
 extern const char *TEST_POSITION_FEN;
 
+// Where and why a FEN was rejected. `offset` is the index of the
+// offending character in the input.
+struct FenParseError {
+    std::size_t offset = 0;
+    const char *message = "";
+};
+
+class FenError : public std::invalid_argument {
+  public:
+    explicit FenError(const FenParseError &error);
+    std::size_t offset() const { return offset_; }
+
+  private:
+    std::size_t offset_;
+};
+
+// Parses without allocating or throwing. The board is only changed when
+// the whole FEN is valid. The halfmove clock and fullmove number may be
+// left out, as in EPD.
+std::optional<FenParseError> try_setup_position(Board &board,
+                                                std::string_view fen);
+
+// Same, but throws FenError
 void setup_initial_position(Board &board,
-                            const std::string &fen = STANDARD_FEN);
+                            std::string_view fen = STANDARD_FEN);
+
+// Longest FEN write_fen can produce, including the terminating zero
+constexpr std::size_t MAX_FEN_LENGTH = 128;
+using FenBuffer = std::array<char, MAX_FEN_LENGTH>;
+
+// Writes a zero-terminated FEN into `buffer` and returns a view of it
+std::string_view write_fen(const Board &board, FenBuffer &buffer);
 std::string export_to_fen(const Board &board);
 
 namespace detail {
-void parse_piece_placement(Board &board, const std::string &fen_part);
-void parse_active_color(Board &board, const std::string &active_color);
-void parse_castling_rights(Board &board, const std::string &castling);
-void parse_en_passant(Board &board, const std::string &en_passant);
-void parse_halfmove_clock(Board &board, const std::string &clock);
-void parse_fullmove_number(Board &board, const std::string &number);
 char piece_to_char(const Piece &piece);
 Piece char_to_piece(char c);
 } // namespace detail
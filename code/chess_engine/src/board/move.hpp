@@ -0,0 +1,17 @@
+#pragma once
+#include "pieces/piece_types.hpp"
+#include <utility>
+
+namespace chess {
+
+using Position = std::pair<int, int>;
+
+// A move in board coordinates. promotion is only read when a pawn reaches
+// the last rank, where NONE stands for a queen.
+struct Move {
+    Position from;
+    Position to;
+    PieceType promotion = PieceType::NONE;
+};
+
+} // namespace chess
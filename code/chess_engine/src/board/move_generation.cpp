@@ -1,119 +1,85 @@
 #include "board/move_generation.hpp"
 #include "board/castling.hpp"
 #include "board/check.hpp"
-#include <algorithm>
-#include <iostream>
+#include "board/geometry.hpp"
+#include <cstdlib>
 
 namespace chess {
 namespace {
 
+// Pawn geometry of one colour, fixed at compile time so the generator
+// has no colour branches
+template <Color Side> struct PawnRules {
+    static constexpr bool white = Side == Color::WHITE;
+    static constexpr int direction = white ? -1 : 1;
+    static constexpr int start_row = white ? 6 : 1;
+    static constexpr int en_passant_row = white ? 3 : 4;
+    static constexpr int attack_side = white ? 0 : 1;
+};
+
+template <Color Side>
 void add_pawn_moves(const Board &board, std::vector<std::pair<int, int>> &moves,
                     std::pair<int, int> pos) {
-    const auto &piece = board.get_piece(pos);
-    int direction = piece.get_color() == Color::WHITE ? -1 : 1;
-    int start_row = piece.get_color() == Color::WHITE ? 6 : 1;
-    int en_passant_row = piece.get_color() == Color::WHITE ? 3 : 4;
+    using Rules = PawnRules<Side>;
 
     // Forward moves
-    if (board.is_empty({pos.first, pos.second + direction})) {
-        moves.emplace_back(pos.first, pos.second + direction);
+    if (board.is_empty({pos.first, pos.second + Rules::direction})) {
+        moves.emplace_back(pos.first, pos.second + Rules::direction);
 
-        if (pos.second == start_row &&
-            board.is_empty({pos.first, pos.second + 2 * direction})) {
-            moves.emplace_back(pos.first, pos.second + 2 * direction);
+        if (pos.second == Rules::start_row &&
+            board.is_empty({pos.first, pos.second + 2 * Rules::direction})) {
+            moves.emplace_back(pos.first, pos.second + 2 * Rules::direction);
         }
     }
 
-    // Captures
-    for (int dx : {-1, 1}) {
-        int x = pos.first + dx;
-        int y = pos.second + direction;
-
-        if (x >= 0 && x < 8 && y >= 0 && y < 8) {
-            // Regular capture
-            if (board.is_enemy({x, y}, piece.get_color())) {
-                moves.emplace_back(x, y);
-            }
-
-            //
-            // En passant capture
-            if (pos.second == en_passant_row && board.en_passant_target_ &&
-                x == board.en_passant_target_->first &&
-                y == board.en_passant_target_->second) {
-                moves.emplace_back(x, y);
-            }
+    // Captures, en passant only from the fifth rank
+    geometry::SquareSet targets =
+        geometry::PAWN_ATTACKS[Rules::attack_side]
+                              [geometry::square_of(pos.first, pos.second)];
+    while (targets) {
+        const int square = geometry::pop_square(targets);
+        const std::pair<int, int> target{geometry::file_of(square),
+                                         geometry::row_of(square)};
+        if (board.is_enemy(target, Side) ||
+            (pos.second == Rules::en_passant_row &&
+             board.en_passant_target() == target)) {
+            moves.push_back(target);
         }
     }
 }
 
-void add_knight_moves(const Board &board,
+// Knight and king moves: every target in the table that is empty or holds
+// an enemy
+void add_leaper_moves(const Board &board,
                       std::vector<std::pair<int, int>> &moves,
-                      std::pair<int, int> pos) {
-    static const std::array<std::pair<int, int>, 8> offsets = {{{1, 2},
-                                                                {2, 1},
-                                                                {-1, 2},
-                                                                {-2, 1},
-                                                                {1, -2},
-                                                                {2, -1},
-                                                                {-1, -2},
-                                                                {-2, -1}}};
-
+                      std::pair<int, int> pos,
+                      const std::array<geometry::SquareSet, 64> &attacks) {
     const auto &piece = board.get_piece(pos);
-    for (const auto &[dx, dy] : offsets) {
-        int x = pos.first + dx;
-        int y = pos.second + dy;
-
-        if (x >= 0 && x < 8 && y >= 0 && y < 8 &&
-            (board.is_empty({x, y}) ||
-             board.is_enemy({x, y}, piece.get_color()))) {
-            moves.emplace_back(x, y);
-        }
-    }
-}
-
-void add_king_moves(const Board &board, std::vector<std::pair<int, int>> &moves,
-                    std::pair<int, int> pos) {
-    static const std::array<std::pair<int, int>, 8> directions = {
-        {{1, 1},     // вправо-вверх
-         {1, 0},     // вправо
-         {1, -1},    // вправо-вниз
-         {0, 1},     // вверх
-         {0, -1},    // вниз
-         {-1, 1},    // влево-вверх  ← ЭТОТ ХОД РАНЬШЕ НЕ РАБОТАЛ
-         {-1, 0},    // влево
-         {-1, -1}}}; // влево-вниз
-
-    const auto &piece = board.get_piece(pos);
-    for (const auto &[dx, dy] : directions) {
-        int x = pos.first + dx;
-        int y = pos.second + dy;
-
-        // Проверяем границы доски
-        if (x < 0 || x >= 8 || y < 0 || y >= 8) {
-            continue;
-        }
-
-        // Клетка должна быть пустой или содержать вражескую фигуру
-        if (board.is_empty({x, y}) ||
-            board.is_enemy({x, y}, piece.get_color())) {
-            moves.emplace_back(x, y);
+    geometry::SquareSet targets =
+        attacks[geometry::square_of(pos.first, pos.second)];
+    while (targets) {
+        const int square = geometry::pop_square(targets);
+        const std::pair<int, int> target{geometry::file_of(square),
+                                         geometry::row_of(square)};
+        if (board.is_empty(target) ||
+            board.is_enemy(target, piece.get_color())) {
+            moves.push_back(target);
         }
     }
 }
 
-template <typename DirIter>
+// Directions first..last - 1 of the geometry table
 void add_sliding_moves(const Board &board,
                        std::vector<std::pair<int, int>> &moves,
-                       std::pair<int, int> pos, DirIter begin, DirIter end) {
+                       std::pair<int, int> pos, int first, int last) {
     const auto &piece = board.get_piece(pos);
-    for (auto it = begin; it != end; ++it) {
-        for (int step = 1; step < 8; ++step) {
-            int x = pos.first + it->first * step;
-            int y = pos.second + it->second * step;
-
-            if (x < 0 || x >= 8 || y < 0 || y >= 8)
-                break;
-
+    const int from = geometry::square_of(pos.first, pos.second);
+    for (int d = first; d < last; ++d) {
+        int x = pos.first;
+        int y = pos.second;
+        for (int step = geometry::RAY_LENGTH[d][from]; step > 0; --step) {
+            x += geometry::DIRECTION_X[d];
+            y += geometry::DIRECTION_Y[d];
             if (board.is_empty({x, y})) {
                 moves.emplace_back(x, y);
             } else {
@@ -137,48 +103,31 @@ MoveGenerator::generate_pseudo_legal_moves(const Board &board,
 
     switch (piece.get_type()) {
         case PieceType::PAWN:
-            add_pawn_moves(board, moves, pos);
+            if (piece.get_color() == Color::WHITE)
+                add_pawn_moves<Color::WHITE>(board, moves, pos);
+            else
+                add_pawn_moves<Color::BLACK>(board, moves, pos);
             break;
 
         case PieceType::KNIGHT:
-            add_knight_moves(board, moves, pos);
+            add_leaper_moves(board, moves, pos, geometry::KNIGHT_ATTACKS);
             break;
 
-        case PieceType::BISHOP: {
-            static const std::array<std::pair<int, int>, 4> bishop_dirs = {
-                {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}}};
-            add_sliding_moves(board, moves, pos, bishop_dirs.begin(),
-                              bishop_dirs.end());
+        case PieceType::BISHOP:
+            add_sliding_moves(board, moves, pos, 4, 8);
             break;
-        }
 
-        case PieceType::ROOK: {
-            static const std::array<std::pair<int, int>, 4> rook_dirs = {
-                {{1, 0}, {-1, 0}, {0, 1}, {0, -1}}};
-            add_sliding_moves(board, moves, pos, rook_dirs.begin(),
-                              rook_dirs.end());
+        case PieceType::ROOK:
+            add_sliding_moves(board, moves, pos, 0, 4);
             break;
-        }
 
-        case PieceType::QUEEN: {
-            static const std::array<std::pair<int, int>, 8> queen_dirs = {
-                {{1, 1},
-                 {1, -1},
-                 {-1, 1},
-                 {-1, -1},
-                 {1, 0},
-                 {-1, 0},
-                 {0, 1},
-                 {0, -1}}};
-            add_sliding_moves(board, moves, pos, queen_dirs.begin(),
-                              queen_dirs.end());
+        case PieceType::QUEEN:
+            add_sliding_moves(board, moves, pos, 0, 8);
             break;
-        }
 
-        case PieceType::KING: {
-            add_king_moves(board, moves, pos);
+        case PieceType::KING:
+            add_leaper_moves(board, moves, pos, geometry::KING_ATTACKS);
             break;
-        }
 
         default:
             break;
@@ -187,66 +136,189 @@ MoveGenerator::generate_pseudo_legal_moves(const Board &board,
     return moves;
 }
 
-std::vector<std::pair<int, int>>
-MoveGenerator::get_legal_moves(const Board &board, std::pair<int, int> pos) {
-    auto pseudo_legal = generate_pseudo_legal_moves(board, pos);
-    std::vector<std::pair<int, int>> legal_moves;
-    const auto &piece = board.get_piece(pos);
+namespace {
 
-    Board temp_board = board;
-    temp_board.current_player = piece.get_color();
-
-    for (const auto &move : pseudo_legal) {
-        // Save original state
-        Piece original_from = temp_board.get_piece(pos);
-        Piece original_to = temp_board.get_piece(move);
-        auto original_en_passant = temp_board.en_passant_target_;
-        auto original_castling = temp_board.castling_rights_;
-
-        // Handle en passant capture
-        if (piece.get_type() == PieceType::PAWN && pos.first != move.first &&
-            board.is_empty(move) && board.en_passant_target_) {
-            int direction = piece.get_color() == Color::WHITE ? -1 : 1;
-            // Проверяем, что идём на поле за целью en passant
-            if (move.first == board.en_passant_target_->first &&
-                move.second == board.en_passant_target_->second - direction) {
-                // Удаляем пешку с поля en_passant_target_
-                temp_board.grid_[board.en_passant_target_->second]
-                                [board.en_passant_target_->first] = Piece();
-            }
-        }
+// Tries the move on a copy of the mailbox and tells whether the mover's
+// king is safe afterwards. Castling is not handled here.
+bool leaves_king_safe(const Board &board, std::pair<int, int> from,
+                      std::pair<int, int> to) {
+    CheckValidator::Codes codes = board.piece_codes();
+    const int from_index = from.second * 8 + from.first;
+    const int to_index = to.second * 8 + to.first;
+    const std::uint8_t moving = codes[from_index];
+    const Color color =
+        (moving & Board::BLACK_CODE) ? Color::BLACK : Color::WHITE;
+    const bool is_king =
+        (moving & 7) == static_cast<std::uint8_t>(PieceType::KING);
+
+    // A pawn moving diagonally to an empty square captures en passant: the
+    // captured pawn stands beside it
+    if ((moving & 7) == static_cast<std::uint8_t>(PieceType::PAWN) &&
+        from.first != to.first && codes[to_index] == 0) {
+        codes[from.second * 8 + to.first] = 0;
+    }
+    codes[to_index] = moving;
+    codes[from_index] = 0;
+
+    const auto king = is_king ? to : CheckValidator::find_king(codes, color);
+    if (king.first == -1)
+        return true;
+    return !CheckValidator::is_attacked(
+        codes, king, color == Color::WHITE ? Color::BLACK : Color::WHITE);
+}
 
-        // Execute move
-        temp_board.grid_[move.second][move.first] = original_from;
-        temp_board.grid_[pos.second][pos.first] = Piece();
+// Calls on_legal(move) for each legal non-castling move of the piece on
+// pos until it returns false
+template <typename OnLegal>
+void for_each_legal_move(const Board &board, std::pair<int, int> pos,
+                         OnLegal on_legal) {
+    for (const auto &move :
+         MoveGenerator::generate_pseudo_legal_moves(board, pos)) {
+        if (leaves_king_safe(board, pos, move) && !on_legal(move))
+            return;
+    }
+}
 
-        // Update castling rights
-        if (piece.get_type() == PieceType::KING ||
-            piece.get_type() == PieceType::ROOK) {
-            CastlingManager::update_castling_rights(temp_board, pos);
-        }
+// Squares strictly between from and to, which lie on one line, are empty
+bool is_path_clear(const Board &board, int from, int to) {
+    geometry::SquareSet between = geometry::BETWEEN[from][to];
+    while (between) {
+        const int square = geometry::pop_square(between);
+        if (!board.is_empty({geometry::file_of(square), geometry::row_of(square)}))
+            return false;
+    }
+    return true;
+}
 
-        if (!CheckValidator::is_check(temp_board, piece.get_color())) {
-            legal_moves.push_back(move);
-        }
+template <Color Side> bool is_pawn_move(const Board &board, const Move &move) {
+    using Rules = PawnRules<Side>;
+    const auto [fx, fy] = move.from;
+    const int dy = move.to.second - fy;
+    if (move.to.first == fx) {
+        if (dy == Rules::direction)
+            return board.is_empty(move.to);
+        return dy == 2 * Rules::direction && fy == Rules::start_row &&
+               board.is_empty({fx, fy + Rules::direction}) &&
+               board.is_empty(move.to);
+    }
+    if (!(geometry::PAWN_ATTACKS[Rules::attack_side]
+                                [geometry::square_of(fx, fy)] &
+          geometry::square_bit(
+              geometry::square_of(move.to.first, move.to.second))))
+        return false;
+    return board.is_enemy(move.to, Side) ||
+           (fy == Rules::en_passant_row &&
+            board.en_passant_target() == move.to);
+}
 
-        // Restore original state
-        temp_board.grid_[pos.second][pos.first] = original_from;
-        temp_board.grid_[move.second][move.first] = original_to;
-        temp_board.en_passant_target_ = original_en_passant;
-        temp_board.castling_rights_ = original_castling;
+bool is_valid_promotion(PieceType type) {
+    switch (type) {
+        case PieceType::NONE:
+        case PieceType::KNIGHT:
+        case PieceType::BISHOP:
+        case PieceType::ROOK:
+        case PieceType::QUEEN:
+            return true;
+        default:
+            return false;
     }
+}
 
-    // Add castling moves
-    if (piece.get_type() == PieceType::KING &&
-        !CheckValidator::is_check(board, piece.get_color())) {
+} // namespace
 
-        // Проверка: король должен быть на E1 (4, 7) или E8 (4, 0)
-        const auto &expected_king_pos = (piece.get_color() == Color::WHITE)
-                                            ? std::make_pair(4, 7)
-                                            : std::make_pair(4, 0);
+bool MoveGenerator::is_pseudo_legal(const Board &board, const Move &move) {
+    const auto [fx, fy] = move.from;
+    const auto [tx, ty] = move.to;
+    if (!board.in_bounds(fx, fy) || !board.in_bounds(tx, ty) ||
+        move.from == move.to)
+        return false;
+
+    const Piece &piece = board.get_piece(move.from);
+    const Color color = board.current_player;
+    if (piece.get_type() == PieceType::NONE ||
+        piece.get_type() == PieceType::HIGHLIGHT || piece.get_color() != color)
+        return false;
+    if (!board.is_empty(move.to) && !board.is_enemy(move.to, color))
+        return false;
+
+    const bool promoting = piece.get_type() == PieceType::PAWN &&
+                           ty == (color == Color::WHITE ? 0 : 7);
+    if (promoting ? !is_valid_promotion(move.promotion)
+                  : move.promotion != PieceType::NONE)
+        return false;
+
+    const int dx = tx - fx;
+    const int dy = ty - fy;
+    const int from = geometry::square_of(fx, fy);
+    const int to = geometry::square_of(tx, ty);
+    // Direction of the line from `from` to `to`, -1 if there is none
+    const int line = geometry::DIRECTION[from][to];
+    switch (piece.get_type()) {
+        case PieceType::PAWN:
+            return color == Color::WHITE
+                       ? is_pawn_move<Color::WHITE>(board, move)
+                       : is_pawn_move<Color::BLACK>(board, move);
+        case PieceType::KNIGHT:
+            return geometry::KNIGHT_ATTACKS[from] & geometry::square_bit(to);
+        case PieceType::BISHOP:
+            return line >= 0 && !geometry::is_straight(line) &&
+                   is_path_clear(board, from, to);
+        case PieceType::ROOK:
+            return line >= 0 && geometry::is_straight(line) &&
+                   is_path_clear(board, from, to);
+        case PieceType::QUEEN:
+            return line >= 0 && is_path_clear(board, from, to);
+        case PieceType::KING:
+            if (geometry::KING_ATTACKS[from] & geometry::square_bit(to))
+                return true;
+            return dy == 0 && std::abs(dx) == 2 &&
+                   CastlingManager::is_castle_pseudo_legal(board, color,
+                                                           dx > 0) &&
+                   move.from == CastlingManager::king_home(color);
+        default:
+            return false;
+    }
+}
+
+bool MoveGenerator::is_legal(const Board &board, const Move &move) {
+    if (!is_pseudo_legal(board, move))
+        return false;
+    if (board.get_piece(move.from).get_type() == PieceType::KING &&
+        std::abs(move.to.first - move.from.first) == 2) {
+        return move.to.first > move.from.first
+                   ? CastlingManager::can_castle_kingside(board,
+                                                          board.current_player)
+                   : CastlingManager::can_castle_queenside(
+                         board, board.current_player);
+    }
+    return leaves_king_safe(board, move.from, move.to);
+}
+
+bool MoveGenerator::has_legal_move(const Board &board,
+                                   std::pair<int, int> pos) {
+    bool found = false;
+    for_each_legal_move(board, pos, [&](std::pair<int, int>) {
+        found = true;
+        return false;
+    });
+    return found;
+}
 
-        if (pos == expected_king_pos) {
+std::vector<std::pair<int, int>>
+MoveGenerator::get_legal_moves(const Board &board, std::pair<int, int> pos) {
+    std::vector<std::pair<int, int>> legal_moves;
+    const auto &piece = board.get_piece(pos);
+    if (piece.get_type() == PieceType::NONE)
+        return legal_moves;
+    for_each_legal_move(board, pos, [&](std::pair<int, int> move) {
+        legal_moves.push_back(move);
+        return true;
+    });
+
+    // Add castling moves
+    if (piece.get_type() == PieceType::KING) {
+        // Проверка: король должен быть на E1 (4, 7) или E8 (4, 0)
+        if (pos == CastlingManager::king_home(piece.get_color())) {
             if (CastlingManager::can_castle_kingside(board,
                                                      piece.get_color())) {
                 legal_moves.emplace_back(pos.first + 2, pos.second);
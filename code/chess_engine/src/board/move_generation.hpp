@@ -11,5 +11,15 @@ class MoveGenerator {
 
     static std::vector<std::pair<int, int>>
     get_legal_moves(const Board &board, std::pair<int, int> position);
+
+    // Stops at the first legal move of the piece. Castling is not tried:
+    // whenever it is legal, so is the king's step towards the rook.
+    static bool has_legal_move(const Board &board,
+                               std::pair<int, int> position);
+
+    // Single-move checks behind Board::is_pseudo_legal and Board::is_legal,
+    // for the side to move
+    static bool is_pseudo_legal(const Board &board, const Move &move);
+    static bool is_legal(const Board &board, const Move &move);
 };
 } // namespace chess
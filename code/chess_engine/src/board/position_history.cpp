@@ -0,0 +1,27 @@
+#include "board/position_history.hpp"
+#include <algorithm>
+
+namespace chess {
+
+void PositionHistory::reset(const Board &board) {
+    keys_.clear();
+    push(board);
+}
+
+bool PositionHistory::is_repetition(const Board &board, int times) const {
+    if (keys_.empty())
+        return false;
+
+    // Same side to move and at least two moves each in between; nothing
+    // before the last capture or pawn move can match
+    const int last = static_cast<int>(keys_.size()) - 1;
+    const int reach = std::min(last, static_cast<int>(board.halfmove_clock_));
+    int count = 1;
+    for (int back = 4; back <= reach; back += 2) {
+        if (keys_[last - back] == keys_[last] && ++count >= times)
+            return true;
+    }
+    return false;
+}
+
+} // namespace chess
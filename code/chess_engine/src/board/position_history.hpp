@@ -0,0 +1,34 @@
+#pragma once
+#include "board/board.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chess {
+
+// Zobrist keys of the positions a game went through, the current one last.
+// Whoever plays moves on a board pushes each new position here; the search
+// copies the game's history and pushes and pops along its line.
+class PositionHistory {
+  public:
+    PositionHistory() = default;
+    explicit PositionHistory(const Board &board) { reset(board); }
+
+    // Forgets earlier positions: `board` starts a new game record
+    void reset(const Board &board);
+    // After a move was made on `board`
+    void push(const Board &board) { keys_.push_back(board.hash()); }
+    void pop() { keys_.pop_back(); }
+
+    bool empty() const { return keys_.empty(); }
+    std::size_t size() const { return keys_.size(); }
+
+    // The current position, `board` and the last one pushed, occurred
+    // `times` times in all, counting itself
+    bool is_repetition(const Board &board, int times = 3) const;
+
+  private:
+    std::vector<std::uint64_t> keys_;
+};
+
+} // namespace chess
@@ -0,0 +1,63 @@
+#include "board/zobrist.hpp"
+
+namespace chess::zobrist {
+
+bool en_passant_capturable(const Board &board) {
+    const auto en_passant = board.en_passant_target();
+    if (!en_passant)
+        return false;
+
+    // Capturing pawns stand beside the pawn that just moved
+    const auto [file, row] = *en_passant;
+    const int pawn_row =
+        board.current_player == Color::WHITE ? row + 1 : row - 1;
+    if (pawn_row < 0 || pawn_row > 7)
+        return false;
+    for (int dx : {-1, 1}) {
+        if (file + dx < 0 || file + dx > 7)
+            continue;
+        const auto &piece = board.get_piece({file + dx, pawn_row});
+        if (piece.get_type() == PieceType::PAWN &&
+            piece.get_color() == board.current_player)
+            return true;
+    }
+    return false;
+}
+
+std::uint64_t state_key(const Board &board) {
+    std::uint64_t key = 0;
+    const auto &rights = board.castling_rights_;
+    if (rights.white_kingside)
+        key ^= KEYS[CASTLING_OFFSET + 0];
+    if (rights.white_queenside)
+        key ^= KEYS[CASTLING_OFFSET + 1];
+    if (rights.black_kingside)
+        key ^= KEYS[CASTLING_OFFSET + 2];
+    if (rights.black_queenside)
+        key ^= KEYS[CASTLING_OFFSET + 3];
+
+    if (en_passant_capturable(board))
+        key ^= KEYS[EN_PASSANT_OFFSET + board.en_passant_target()->first];
+
+    if (board.current_player == Color::WHITE)
+        key ^= KEYS[TURN_OFFSET];
+    return key;
+}
+
+std::uint64_t hash(const Board &board) {
+    std::uint64_t key = state_key(board);
+
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            const auto &piece = board.get_piece({x, y});
+            if (piece.get_type() == PieceType::NONE ||
+                piece.get_type() == PieceType::HIGHLIGHT)
+                continue;
+            key ^= KEYS[piece_key_index(piece.get_type(), piece.get_color(),
+                                        {x, y})];
+        }
+    }
+    return key;
+}
+
+} // namespace chess::zobrist
@@ -0,0 +1,73 @@
+#pragma once
+#include "board/board.hpp"
+#include <array>
+#include <cstdint>
+
+namespace chess::zobrist {
+
+// Key layout follows Polyglot: 768 piece-square keys, four castling keys,
+// eight en passant file keys and the white-to-move key. The values come
+// from a fixed-seed generator instead of Polyglot's Random64 table, so books
+// are interchangeable with book_convert output only; reading third-party
+// books needs the canonical table in KEYS, which POLYGLOT_KEYS confirms.
+constexpr int CASTLING_OFFSET = 768;
+constexpr int EN_PASSANT_OFFSET = 772;
+constexpr int TURN_OFFSET = 780;
+constexpr int KEY_COUNT = 781;
+
+constexpr std::array<std::uint64_t, KEY_COUNT> KEYS = [] {
+    std::array<std::uint64_t, KEY_COUNT> keys{};
+    std::uint64_t state = 0x45434232303235ULL; // splitmix64
+    for (auto &key : keys) {
+        state += 0x9E3779B97F4A7C15ULL;
+        std::uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        key = z ^ (z >> 31);
+    }
+    return keys;
+}();
+
+// Polyglot piece kinds run black pawn, white pawn, black knight, ...; rows
+// count from rank 1, so y = 0 on the board is row 7.
+constexpr int piece_key_index(PieceType type, Color color, Position square) {
+    const int kind =
+        2 * (static_cast<int>(type) - 1) + (color == Color::WHITE ? 1 : 0);
+    return 64 * kind + 8 * (7 - square.second) + square.first;
+}
+
+// Key of the initial position, computed from KEYS
+constexpr std::uint64_t start_position_key() {
+    constexpr PieceType back_rank[8] = {
+        PieceType::ROOK,  PieceType::KNIGHT, PieceType::BISHOP,
+        PieceType::QUEEN, PieceType::KING,   PieceType::BISHOP,
+        PieceType::KNIGHT, PieceType::ROOK};
+    std::uint64_t key = KEYS[TURN_OFFSET];
+    for (int i = 0; i < 4; ++i)
+        key ^= KEYS[CASTLING_OFFSET + i];
+    for (int x = 0; x < 8; ++x) {
+        key ^= KEYS[piece_key_index(back_rank[x], Color::WHITE, {x, 7})] ^
+               KEYS[piece_key_index(PieceType::PAWN, Color::WHITE, {x, 6})] ^
+               KEYS[piece_key_index(PieceType::PAWN, Color::BLACK, {x, 1})] ^
+               KEYS[piece_key_index(back_rank[x], Color::BLACK, {x, 0})];
+    }
+    return key;
+}
+
+// The initial position's key in Polyglot's own documentation. KEYS is the
+// canonical Random64 table exactly when it reproduces this key.
+constexpr std::uint64_t POLYGLOT_START_KEY = 0x463B96181691FC9CULL;
+constexpr bool POLYGLOT_KEYS = start_position_key() == POLYGLOT_START_KEY;
+
+// True if a pawn of the side to move can capture en passant
+bool en_passant_capturable(const Board &board);
+
+// Castling, en passant and side to move part of the key
+std::uint64_t state_key(const Board &board);
+
+// Full hash of the position from scratch; Board::hash() keeps the same key
+// incrementally. En passant is only hashed when the capture is
+// possible, as Polyglot does.
+std::uint64_t hash(const Board &board);
+
+} // namespace chess::zobrist
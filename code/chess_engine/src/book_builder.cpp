@@ -0,0 +1,411 @@
+#include "board/board.hpp"
+#include "board/zobrist.hpp"
+#include "engine/mapped_file.hpp"
+#include "engine/opening_book.hpp"
+#include "engine/polyglot_book.hpp"
+#include "engine/san.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Сборка дебютной книги из партий PGN:
+//   book_builder [--plies N] [--threads N] [--min-count N] OUTPUT INPUT.pgn...
+// OUTPUT с расширением .bin пишется в формате Polyglot, иначе текстом
+// в формате assets/opening_book.txt
+
+namespace {
+
+using chess::engine::Move;
+using chess::engine::PolyglotBook;
+
+struct Options {
+    int plies = 20;
+    int threads = 0;
+    int minCount = 1;
+    bool binary = false;
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+// Ход хранится двумя кодами: младшие 16 бит — Polyglot, старшие — ход на
+// доске (from, to, превращение) для текстового формата
+std::uint32_t packMove(const chess::Board &board,
+                       const chess::engine::SanMove &san) {
+    Move move = san.move;
+    move.promotion = san.promotion;
+    const int promotion =
+        san.promotion == chess::PieceType::NONE
+            ? 0
+            : static_cast<int>(san.promotion) -
+                  static_cast<int>(chess::PieceType::PAWN);
+    const std::uint32_t polyglot = PolyglotBook::encode_move(board, move);
+    const std::uint32_t text = (move.from.second * 8 + move.from.first) |
+                               ((move.to.second * 8 + move.to.first) << 6) |
+                               (promotion << 12);
+    return polyglot | (text << 16);
+}
+
+std::string moveText(std::uint32_t packed) {
+    const std::uint32_t text = packed >> 16;
+    const int from = text & 63;
+    const int to = (text >> 6) & 63;
+    std::string result = {static_cast<char>('a' + from % 8),
+                          static_cast<char>('8' - from / 8),
+                          static_cast<char>('a' + to % 8),
+                          static_cast<char>('8' - to / 8)};
+    const int promotion = (text >> 12) & 7;
+    if (promotion)
+        result += "nbrq"[promotion - 1];
+    return result;
+}
+
+struct PositionStats {
+    std::string key; // FEN-ключ, только для текстового формата
+    std::unordered_map<std::uint32_t, std::uint32_t> moves;
+};
+using Stats = std::unordered_map<std::uint64_t, PositionStats>;
+
+struct WorkerResult {
+    Stats stats;
+    std::size_t games = 0;
+    std::size_t rejected = 0; // партии с непонятым или нелегальным ходом
+};
+
+// Разбор куска PGN, выровненного по началу партии
+class PgnWorker {
+  public:
+    PgnWorker(const Options &options, WorkerResult &result)
+        : options_(options), result_(result) {}
+
+    void run(std::string_view text) {
+        std::size_t pos = 0;
+        while (pos < text.size()) {
+            std::size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos)
+                end = text.size();
+            processLine(text.substr(pos, end - pos));
+            pos = end + 1;
+        }
+    }
+
+  private:
+    const Options &options_;
+    WorkerResult &result_;
+
+    chess::Board board_;
+    int ply_ = 0;
+    bool inHeaders_ = false;
+    bool skipMoves_ = true;
+    int commentDepth_ = 0;   // {...} может занимать несколько строк
+    int variationDepth_ = 0; // (...)
+
+    void startGame() {
+        board_ = chess::Board();
+        ply_ = 0;
+        skipMoves_ = false;
+        commentDepth_ = 0;
+        variationDepth_ = 0;
+        result_.games++;
+    }
+
+    void processLine(std::string_view line) {
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        if (commentDepth_ == 0 && !line.empty() && line.front() == '[') {
+            if (!inHeaders_) {
+                inHeaders_ = true;
+                startGame();
+            }
+            processTag(line);
+            return;
+        }
+        if (line.empty())
+            return;
+        inHeaders_ = false;
+        processMovetext(line);
+    }
+
+    void processTag(std::string_view line) {
+        if (line.rfind("[FEN \"", 0) != 0)
+            return;
+        const std::size_t end = line.find('"', 6);
+        if (end == std::string_view::npos)
+            return;
+        try {
+            board_ = chess::Board(std::string(line.substr(6, end - 6)));
+        } catch (const std::invalid_argument &) {
+            rejectGame();
+        }
+    }
+
+    void rejectGame() {
+        if (!skipMoves_)
+            result_.rejected++;
+        skipMoves_ = true;
+    }
+
+    void processMovetext(std::string_view line) {
+        std::size_t i = 0;
+        while (i < line.size()) {
+            const char c = line[i];
+            if (commentDepth_ > 0) {
+                if (c == '}')
+                    commentDepth_--;
+                i++;
+            } else if (c == '{') {
+                commentDepth_++;
+                i++;
+            } else if (c == ';') {
+                return; // комментарий до конца строки
+            } else if (c == '(') {
+                variationDepth_++;
+                i++;
+            } else if (c == ')') {
+                variationDepth_ = std::max(0, variationDepth_ - 1);
+                i++;
+            } else if (c == ' ' || c == '\t') {
+                i++;
+            } else {
+                std::size_t end = i;
+                while (end < line.size() &&
+                       std::string_view(" \t{}();").find(line[end]) ==
+                           std::string_view::npos)
+                    end++;
+                if (variationDepth_ == 0)
+                    processToken(line.substr(i, end - i));
+                i = end;
+            }
+        }
+    }
+
+    void processToken(std::string_view token) {
+        if (token.front() == '$')
+            return;
+        if (token == "1-0" || token == "0-1" || token == "1/2-1/2" ||
+            token == "*") {
+            skipMoves_ = true;
+            return;
+        }
+
+        // Номер хода: "12." или "12..." (в т.ч. слитно с ходом: "12.e4")
+        std::size_t digits = 0;
+        while (digits < token.size() && token[digits] >= '0' &&
+               token[digits] <= '9')
+            digits++;
+        if (digits > 0 && digits < token.size() && token[digits] == '.') {
+            while (digits < token.size() && token[digits] == '.')
+                digits++;
+            token.remove_prefix(digits);
+        }
+        if (token.empty() || skipMoves_ || ply_ >= options_.plies)
+            return;
+
+        const auto san = chess::engine::parse_san(board_, token);
+        if (!san) {
+            rejectGame();
+            return;
+        }
+
+        auto &position = result_.stats[chess::zobrist::hash(board_)];
+        if (!options_.binary && position.key.empty())
+            position.key = chess::engine::OpeningBook::positionKey(board_);
+        position.moves[packMove(board_, *san)]++;
+
+        // parse_san находит только легальные ходы
+        board_.apply_move({san->move.from, san->move.to, san->promotion});
+        ply_++;
+    }
+};
+
+// Границы кусков для потоков: каждый начинается с тега [Event
+std::vector<std::string_view> splitGames(std::string_view text, int parts) {
+    std::vector<std::size_t> starts = {0};
+    for (int i = 1; i < parts; ++i) {
+        std::size_t pos = text.size() * i / parts;
+        pos = text.find("\n[Event ", std::max(pos, starts.back()));
+        if (pos == std::string_view::npos)
+            break;
+        starts.push_back(pos + 1);
+    }
+    starts.push_back(text.size());
+
+    std::vector<std::string_view> chunks;
+    for (std::size_t i = 0; i + 1 < starts.size(); ++i) {
+        if (starts[i + 1] > starts[i])
+            chunks.push_back(text.substr(starts[i], starts[i + 1] - starts[i]));
+    }
+    return chunks;
+}
+
+void merge(Stats &into, Stats &from) {
+    for (auto &[hash, position] : from) {
+        auto &target = into[hash];
+        if (target.key.empty())
+            target.key = std::move(position.key);
+        for (const auto &[move, count] : position.moves)
+            target.moves[move] += count;
+    }
+    from.clear();
+}
+
+std::vector<std::pair<std::uint32_t, std::uint32_t>>
+sortedMoves(const PositionStats &position, int minCount) {
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> moves;
+    for (const auto &[move, count] : position.moves) {
+        if (count >= static_cast<std::uint32_t>(minCount))
+            moves.emplace_back(move, count);
+    }
+    std::sort(moves.begin(), moves.end(), [](const auto &a, const auto &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    return moves;
+}
+
+std::size_t writeText(const Stats &stats, const Options &options) {
+    std::vector<const PositionStats *> positions;
+    for (const auto &[hash, position] : stats)
+        positions.push_back(&position);
+    std::sort(positions.begin(), positions.end(),
+              [](const auto *a, const auto *b) { return a->key < b->key; });
+
+    std::ofstream out(options.output, std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot write book: " + options.output);
+
+    std::size_t written = 0;
+    for (const auto *position : positions) {
+        const auto moves = sortedMoves(*position, options.minCount);
+        if (moves.empty())
+            continue;
+        out << "pos " << position->key << "\n";
+        for (const auto &[move, count] : moves)
+            out << moveText(move) << " " << count << "\n";
+        written++;
+    }
+    if (!out)
+        throw std::runtime_error("Cannot write book: " + options.output);
+    return written;
+}
+
+std::size_t writeBinary(const Stats &stats, const Options &options) {
+    std::vector<PolyglotBook::Entry> entries;
+    std::size_t written = 0;
+    for (const auto &[hash, position] : stats) {
+        const auto moves = sortedMoves(position, options.minCount);
+        if (moves.empty())
+            continue;
+        for (const auto &[move, count] : moves) {
+            entries.push_back(
+                {hash, static_cast<std::uint16_t>(move & 0xFFFF),
+                 PolyglotBook::scale_weight(count, moves.front().second), 0});
+        }
+        written++;
+    }
+    PolyglotBook::write(options.output, std::move(entries));
+    return written;
+}
+
+bool parseArguments(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--plies" && i + 1 < argc) {
+            options.plies = std::stoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::stoi(argv[++i]);
+        } else if (arg == "--min-count" && i + 1 < argc) {
+            options.minCount = std::stoi(argv[++i]);
+        } else if (options.output.empty()) {
+            options.output = arg;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.output.empty() || options.inputs.empty())
+        return false;
+
+    const std::string binaryExtension = ".bin";
+    options.binary =
+        options.output.size() >= binaryExtension.size() &&
+        options.output.compare(options.output.size() - binaryExtension.size(),
+                               binaryExtension.size(), binaryExtension) == 0;
+    if (options.threads <= 0)
+        options.threads =
+            std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    try {
+        if (!parseArguments(argc, argv, options)) {
+            std::cerr << "Использование: book_builder [--plies N] "
+                         "[--threads N] [--min-count N] OUTPUT INPUT.pgn...\n"
+                      << "  OUTPUT *.bin - книга Polyglot, иначе текстовая\n";
+            return 1;
+        }
+    } catch (const std::exception &) {
+        std::cerr << "Некорректное числовое значение аргумента\n";
+        return 1;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    Stats stats;
+    std::size_t games = 0;
+    std::size_t rejected = 0;
+
+    for (const auto &input : options.inputs) {
+        chess::engine::MappedFile file(input, true);
+        if (file.empty()) {
+            std::cerr << "Не удалось открыть " << input << "\n";
+            return 1;
+        }
+        const std::string_view text(reinterpret_cast<const char *>(file.data()),
+                                    file.size());
+        const auto chunks = splitGames(text, options.threads);
+
+        std::vector<WorkerResult> results(chunks.size());
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            workers.emplace_back([&, i] {
+                PgnWorker(options, results[i]).run(chunks[i]);
+            });
+        }
+        for (auto &worker : workers)
+            worker.join();
+
+        for (auto &result : results) {
+            merge(stats, result.stats);
+            games += result.games;
+            rejected += result.rejected;
+        }
+    }
+
+    std::size_t positions = 0;
+    try {
+        positions = options.binary ? writeBinary(stats, options)
+                                   : writeText(stats, options);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+    std::cout << "Партий: " << games << " (отброшено " << rejected
+              << "), позиций в книге: " << positions << ", время: " << seconds
+              << " с\n";
+    return 0;
+}
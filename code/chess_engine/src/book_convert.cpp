@@ -0,0 +1,123 @@
+#include "board/board.hpp"
+#include "board/zobrist.hpp"
+#include "engine/polyglot_book.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Конвертация текстовой дебютной книги (assets/opening_book.txt) в
+// бинарный формат Polyglot:
+//   book_convert assets/opening_book.txt assets/opening_book.bin
+
+namespace {
+
+using chess::engine::Move;
+using chess::engine::PolyglotBook;
+
+bool parseMove(const std::string &text, Move &move) {
+    if (text.size() < 4 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' ||
+        text[1] > '8' || text[2] < 'a' || text[2] > 'h' || text[3] < '1' ||
+        text[3] > '8')
+        return false;
+    move = {{text[0] - 'a', '8' - text[1]}, {text[2] - 'a', '8' - text[3]}};
+    // Превращение пишется пятой буквой, как в book_builder: "e7e8q"
+    if (text.size() > 4) {
+        static const std::string letters = "nbrq";
+        static constexpr chess::PieceType types[] = {
+            chess::PieceType::KNIGHT, chess::PieceType::BISHOP,
+            chess::PieceType::ROOK, chess::PieceType::QUEEN};
+        const auto index = letters.find(text[4]);
+        if (index == std::string::npos)
+            return false;
+        move.promotion = types[index];
+    }
+    return true;
+}
+
+// Частоты в книге больше 16 бит: масштабируем веса позиции
+void appendPosition(const chess::Board &board,
+                    const std::vector<std::pair<Move, int>> &moves,
+                    std::vector<PolyglotBook::Entry> &entries) {
+    int maxFrequency = 0;
+    for (const auto &[move, frequency] : moves)
+        maxFrequency = std::max(maxFrequency, frequency);
+
+    const std::uint64_t key = chess::zobrist::hash(board);
+    for (const auto &[move, frequency] : moves) {
+        entries.push_back({key, PolyglotBook::encode_move(board, move),
+                           PolyglotBook::scale_weight(frequency, maxFrequency),
+                           0});
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "Использование: book_convert INPUT.txt OUTPUT.bin\n";
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input) {
+        std::cerr << "Не удалось открыть " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<PolyglotBook::Entry> entries;
+    std::vector<std::pair<Move, int>> moves;
+    chess::Board board;
+    bool havePosition = false;
+    size_t positions = 0;
+    size_t skipped = 0;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty())
+            continue;
+
+        if (line.rfind("pos ", 0) == 0) {
+            if (havePosition)
+                appendPosition(board, moves, entries);
+            moves.clear();
+            try {
+                // В ключах книги нет счётчиков ходов
+                board = chess::Board(line.substr(4) + " 0 1");
+                havePosition = true;
+                positions++;
+            } catch (const std::invalid_argument &) {
+                havePosition = false;
+                skipped++;
+            }
+            continue;
+        }
+
+        std::istringstream iss(line);
+        std::string moveText;
+        int frequency = 0;
+        Move move;
+        if (havePosition && iss >> moveText >> frequency &&
+            parseMove(moveText, move)) {
+            moves.emplace_back(move, frequency);
+        }
+    }
+    if (havePosition)
+        appendPosition(board, moves, entries);
+
+    try {
+        PolyglotBook::write(argv[2], entries);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "Позиций: " << positions << ", записей: " << entries.size();
+    if (skipped > 0)
+        std::cout << ", пропущено некорректных FEN: " << skipped;
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,561 @@
+#include "board/board.hpp"
+#include "board/check_info.hpp"
+#include "board/initialization.hpp"
+#include "engine/move_generator.hpp"
+#include "engine/nnue_evaluator.hpp"
+#include "engine/opening_book.hpp"
+#include "engine/position_evaluator.hpp"
+#include "engine/simd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Микробенчмарки отдельных слоёв движка: FEN, генерация ходов, проверки
+// шаха, оценка и дебютная книга. Для каждого замера - время в нс на
+// операцию и число выделений памяти на операцию:
+//   chess_bench [фильтр] [--min-time MS]
+// Фильтр - подстрока имени замера (например, eval/ или movegen/).
+//   chess_bench --check-nnue
+// сверяет NNUE на сгенерированной сети: инкрементальные аккумуляторы с
+// пересчётом с нуля и векторные ядра со скалярными.
+
+namespace {
+
+std::atomic<std::uint64_t> allocationCount{0};
+std::atomic<std::uint64_t> allocatedBytes{0};
+
+// Перед каждым блоком лежит указатель, полученный от malloc, поэтому
+// обычные и выровненные блоки освобождаются одинаково
+void *allocate(std::size_t size, std::size_t alignment) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    void *raw = std::malloc(size + alignment + sizeof(void *));
+    if (!raw)
+        return nullptr;
+    const std::uintptr_t start =
+        reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *);
+    void **block = reinterpret_cast<void **>((start + alignment - 1) &
+                                             ~(alignment - 1));
+    block[-1] = raw;
+    return block;
+}
+
+void *allocateOrThrow(std::size_t size, std::size_t alignment) {
+    if (void *pointer = allocate(size, alignment))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void release(void *pointer) noexcept {
+    if (pointer)
+        std::free(static_cast<void **>(pointer)[-1]);
+}
+
+} // namespace
+
+// Все выделения процесса проходят через счётчики: заменён весь набор
+// operator new/delete, включая nothrow и выровненные варианты
+void *operator new(std::size_t size) { return allocateOrThrow(size, 0); }
+void *operator new[](std::size_t size) { return allocateOrThrow(size, 0); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size, 0);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size, 0);
+}
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept { release(pointer); }
+void operator delete[](void *pointer) noexcept { release(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { release(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept {
+    release(pointer);
+}
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+    release(pointer);
+}
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+    release(pointer);
+}
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    release(pointer);
+}
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    release(pointer);
+}
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+    release(pointer);
+}
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+    release(pointer);
+}
+void operator delete(void *pointer, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+    release(pointer);
+}
+void operator delete[](void *pointer, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+    release(pointer);
+}
+
+namespace {
+
+using chess::Board;
+using chess::Color;
+using chess::PieceType;
+using chess::Position;
+
+// Не даёт компилятору выбросить вычисление, результат которого не нужен
+template <typename T> void keep(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+const char *KIWIPETE_FEN =
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+const char *MIDDLEGAME_FEN =
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16";
+const char *ENDGAME_FEN = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11";
+const char *MATE_FEN =
+    "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3";
+const char *PROMOTION_FEN = "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1";
+
+struct Benchmark {
+    std::string name;
+    int opsPerCall; // операций за один вызов body
+    std::function<void()> body;
+};
+
+// Открывает защищённые члены оценщика для замеров по отдельности
+class EvaluatorProbe : public chess::engine::PositionEvaluator {
+  public:
+    using PositionEvaluator::AttackInfo;
+    using PositionEvaluator::build_attack_info;
+    using PositionEvaluator::evaluate_incremental;
+    using PositionEvaluator::evaluate_king_safety;
+    using PositionEvaluator::evaluate_material;
+    using PositionEvaluator::evaluate_pawn_structure;
+    using PositionEvaluator::evaluate_piece_mobility;
+    using PositionEvaluator::evaluate_positional;
+    using PositionEvaluator::evaluate_threats;
+};
+
+// Генератор без поиска: нужен только generateAllMoves
+class MovesOnly : public chess::engine::MoveGenerator {
+  public:
+    chess::engine::Move generateBestMove(Board &, Color,
+                                         const chess::PositionHistory &) override {
+        return {};
+    }
+    chess::engine::SearchResult search(Board &, Color,
+                                       const chess::PositionHistory &,
+                                       const chess::engine::SearchLimits &,
+                                       chess::engine::SearchSignals &,
+                                       const chess::engine::InfoCallback &) override {
+        return {};
+    }
+};
+
+const char *pieceName(PieceType type) {
+    switch (type) {
+    case PieceType::PAWN:
+        return "pawn";
+    case PieceType::KNIGHT:
+        return "knight";
+    case PieceType::BISHOP:
+        return "bishop";
+    case PieceType::ROOK:
+        return "rook";
+    case PieceType::QUEEN:
+        return "queen";
+    default:
+        return "king";
+    }
+}
+
+std::vector<Benchmark> makeBenchmarks() {
+    std::vector<Benchmark> list;
+
+    // FEN
+    const std::pair<const char *, const char *> fens[] = {
+        {"start", chess::BoardInitializer::STANDARD_FEN},
+        {"kiwipete", KIWIPETE_FEN},
+        {"endgame", ENDGAME_FEN}};
+    for (const auto &[name, fen] : fens) {
+        const std::string text = fen;
+        list.push_back({std::string("fen/parse/") + name, 1, [text] {
+                            Board board(text);
+                            keep(board);
+                        }});
+    }
+    // Только разбор, в уже созданную доску
+    list.push_back({"fen/try_setup_position/kiwipete", 1, [board = Board()]() mutable {
+                        auto error = chess::BoardInitializer::try_setup_position(
+                            board, KIWIPETE_FEN);
+                        keep(error);
+                    }});
+    list.push_back({"fen/export/kiwipete", 1, [board = Board(KIWIPETE_FEN)] {
+                        auto fen = chess::BoardInitializer::export_to_fen(board);
+                        keep(fen);
+                    }});
+    list.push_back({"fen/write_fen/kiwipete", 1, [board = Board(KIWIPETE_FEN)] {
+                        chess::BoardInitializer::FenBuffer buffer;
+                        auto fen = chess::BoardInitializer::write_fen(board, buffer);
+                        keep(fen);
+                    }});
+
+    // Генерация ходов: одна операция - один вызов get_legal_moves для
+    // фигуры данного типа стороны, которая ходит
+    const Board kiwipete(KIWIPETE_FEN);
+    for (PieceType type : {PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP,
+                           PieceType::ROOK, PieceType::QUEEN, PieceType::KING}) {
+        std::vector<Position> squares;
+        for (int y = 0; y < 8; ++y) {
+            for (int x = 0; x < 8; ++x) {
+                const auto &piece = kiwipete.get_piece({x, y});
+                if (piece.get_type() == type &&
+                    piece.get_color() == kiwipete.current_player)
+                    squares.push_back({x, y});
+            }
+        }
+        list.push_back({std::string("movegen/get_legal_moves/") + pieceName(type),
+                        static_cast<int>(squares.size()), [kiwipete, squares] {
+                            for (const auto &square : squares) {
+                                auto moves = kiwipete.get_legal_moves(square);
+                                keep(moves);
+                            }
+                        }});
+    }
+    // Проверка одного хода, как при вводе из UCI или GUI: e1g1 - рокировка,
+    // d5e6 - взятие, e5f7 - ход коня
+    const std::vector<chess::Move> inputMoves = {
+        {{4, 7}, {6, 7}}, {{3, 3}, {4, 2}}, {{4, 3}, {5, 1}}};
+    list.push_back({"movegen/is_legal/kiwipete",
+                    static_cast<int>(inputMoves.size()), [kiwipete, inputMoves] {
+                        for (const auto &move : inputMoves) {
+                            bool legal = kiwipete.is_legal(move);
+                            keep(legal);
+                        }
+                    }});
+    list.push_back({"movegen/generate_all/kiwipete", 1, [kiwipete] {
+                        static MovesOnly generator;
+                        auto moves = generator.generateAllMoves(
+                            kiwipete, kiwipete.current_player);
+                        keep(moves);
+                    }});
+
+    // Копия доски и ход на копии, как в поиске; те же три хода
+    list.push_back({"board/copy_apply/kiwipete",
+                    static_cast<int>(inputMoves.size()), [kiwipete, inputMoves] {
+                        for (const auto &move : inputMoves) {
+                            Board board = kiwipete;
+                            board.apply_move(move);
+                            keep(board);
+                        }
+                    }});
+
+    // Атаки и шах; is_attacked - по всем 64 клеткам
+    list.push_back({"check/is_attacked/kiwipete", 64, [kiwipete] {
+                        for (int y = 0; y < 8; ++y) {
+                            for (int x = 0; x < 8; ++x) {
+                                bool attacked = kiwipete.is_attacked({x, y}, Color::BLACK);
+                                keep(attacked);
+                            }
+                        }
+                    }});
+    list.push_back({"check/is_check/kiwipete", 1, [kiwipete] {
+                        bool check = kiwipete.is_check(Color::WHITE);
+                        keep(check);
+                    }});
+    list.push_back({"check/is_checkmate/kiwipete", 1, [board = kiwipete]() mutable {
+                        bool mate = board.is_checkmate(Color::WHITE);
+                        keep(mate);
+                    }});
+    // gives_check - по всем легальным ходам позиции, с одной CheckInfo
+    const auto kiwipeteMoves = MovesOnly().generateAllMoves(kiwipete, kiwipete.current_player);
+    list.push_back({"check/check_info/kiwipete", 1, [kiwipete] {
+                        chess::CheckInfo info(kiwipete);
+                        keep(info);
+                    }});
+    list.push_back({"check/gives_check/kiwipete",
+                    static_cast<int>(kiwipeteMoves.size()), [kiwipete, kiwipeteMoves] {
+                        const chess::CheckInfo info(kiwipete);
+                        for (const auto &move : kiwipeteMoves) {
+                            bool check = info.gives_check(kiwipete, move);
+                            keep(check);
+                        }
+                    }});
+    list.push_back({"check/is_checkmate/mate", 1, [board = Board(MATE_FEN)]() mutable {
+                        bool mate = board.is_checkmate(Color::WHITE);
+                        keep(mate);
+                    }});
+
+    // Оценка: полная, ленивая и каждое слагаемое отдельно
+    const Board middlegame(MIDDLEGAME_FEN);
+    auto probe = std::make_shared<EvaluatorProbe>();
+    const auto info = std::make_shared<EvaluatorProbe::AttackInfo>(
+        probe->build_attack_info(middlegame));
+    auto term = [&](const std::string &name, std::function<int()> body) {
+        list.push_back({"eval/" + name, 1, [body] {
+                            int score = body();
+                            keep(score);
+                        }});
+    };
+    term("evaluate", [probe, middlegame] {
+        return probe->evaluate(middlegame, Color::WHITE);
+    });
+    term("evaluate_lazy_exit", [probe, middlegame] {
+        return probe->evaluate(middlegame, Color::WHITE, 2000, 2001);
+    });
+    term("evaluate_full", [probe, middlegame] {
+        return probe->evaluate_full(middlegame, Color::WHITE);
+    });
+    term("incremental", [probe, middlegame] {
+        return probe->evaluate_incremental(middlegame, Color::WHITE);
+    });
+    term("material", [probe, middlegame] {
+        return probe->evaluate_material(middlegame, Color::WHITE);
+    });
+    term("positional", [probe, middlegame] {
+        return probe->evaluate_positional(middlegame, Color::WHITE);
+    });
+    term("attack_info", [probe, middlegame] {
+        return probe->build_attack_info(middlegame).mobility[0];
+    });
+    term("threats", [probe, info] {
+        return probe->evaluate_threats(*info, Color::WHITE);
+    });
+    term("pawn_structure", [probe, middlegame] {
+        return probe->evaluate_pawn_structure(middlegame, Color::WHITE);
+    });
+    term("mobility", [probe, info] {
+        return probe->evaluate_piece_mobility(*info, Color::WHITE);
+    });
+    term("king_safety", [probe, middlegame, info] {
+        return probe->evaluate_king_safety(middlegame, *info, Color::WHITE);
+    });
+
+    // Дебютная книга
+    const std::string bookPath = chess::engine::OpeningBook::defaultPath();
+    list.push_back({"book/load", 1, [bookPath] {
+                        chess::engine::OpeningBook book(bookPath);
+                        keep(book);
+                    }});
+    auto book = std::make_shared<chess::engine::OpeningBook>(bookPath);
+    list.push_back({"book/lookup/start", 1, [book, board = Board()] {
+                        auto move = book->getOpeningMove(board, Color::WHITE);
+                        keep(move);
+                    }});
+    list.push_back({"book/position_key/kiwipete", 1, [kiwipete] {
+                        auto key = chess::engine::OpeningBook::positionKey(kiwipete);
+                        keep(key);
+                    }});
+
+    return list;
+}
+
+// Проверка NNUE
+
+// Случайная сеть. Веса признаков малы, чтобы аккумуляторы не выходили за
+// int16. Выходные веса - предельные 16-битные: при hidden = 256 сумма
+// половины ещё помещается в int32. Первая половина нейронов всегда
+// насыщена (смещение выше ACTIVATION_LIMIT), так что скалярная сумма
+// близка к этому пределу
+std::shared_ptr<const chess::engine::NnueNetwork> makeTestNetwork() {
+    using chess::engine::NnueNetwork;
+    constexpr int hidden = 256;
+    constexpr int saturated = hidden / 2;
+    std::mt19937 random(12345);
+    auto uniform = [&random](int limit) {
+        return static_cast<std::int16_t>(
+            std::uniform_int_distribution<int>(-limit, limit)(random));
+    };
+
+    auto network = std::make_shared<NnueNetwork>();
+    network->hidden = hidden;
+    for (int i = 0; i < hidden; ++i)
+        network->feature_biases.push_back(i < saturated ? 800 : uniform(128));
+    network->feature_weights.resize(static_cast<std::size_t>(NnueNetwork::INPUTS) *
+                                    hidden);
+    for (auto &weight : network->feature_weights)
+        weight = uniform(16);
+    for (int half = 0; half < 2; ++half) {
+        for (int i = 0; i < hidden; ++i)
+            network->output_weights.push_back(
+                i < saturated ? 32767 : (uniform(1) < 0 ? -32768 : 32767));
+    }
+    network->output_bias = 1000;
+    return network;
+}
+
+// Обходит случайное дерево ходов глубины depth, вызывая push/pop как
+// поиск, и пишет оценку каждого узла. Пересчёт с нуля делает второй
+// оценщик без состояния; расхождения считаются в mismatches
+void walkNnue(const Board &board, int depth, std::mt19937 &random,
+              chess::engine::NnueEvaluator &incremental,
+              chess::engine::NnueEvaluator &fresh, std::vector<int> &scores,
+              int &mismatches) {
+    const int score = incremental.evaluate(board, Color::WHITE);
+    scores.push_back(score);
+    if (score != fresh.evaluate(board, Color::WHITE))
+        mismatches++;
+    if (depth == 0)
+        return;
+
+    static MovesOnly generator;
+    auto moves = generator.generateAllMoves(board, board.current_player);
+    std::shuffle(moves.begin(), moves.end(), random);
+    moves.resize(std::min<std::size_t>(moves.size(), 4));
+    for (const auto &move : moves) {
+        Board child = board;
+        child.apply_move(move);
+        incremental.push(board, child);
+        walkNnue(child, depth - 1, random, incremental, fresh, scores,
+                 mismatches);
+        incremental.pop();
+    }
+}
+
+// Оценки всех узлов обхода на текущем уровне ядер
+std::vector<int> nnueScores(
+    const std::shared_ptr<const chess::engine::NnueNetwork> &network,
+    int &mismatches) {
+    std::vector<int> scores;
+    std::mt19937 random(2024);
+    for (const char *fen : {chess::BoardInitializer::STANDARD_FEN, KIWIPETE_FEN,
+                            MIDDLEGAME_FEN, ENDGAME_FEN, PROMOTION_FEN}) {
+        const Board board(fen);
+        chess::engine::NnueEvaluator incremental(network);
+        chess::engine::NnueEvaluator fresh(network);
+        incremental.reset(board);
+        walkNnue(board, 4, random, incremental, fresh, scores, mismatches);
+        incremental.finish();
+    }
+    return scores;
+}
+
+int checkNnue() {
+    namespace simd = chess::engine::simd;
+    const auto network = makeTestNetwork();
+    if (!network->output_fits_int32()) {
+        std::cout << "nnue: тестовая сеть выходит за int32\n";
+        return 1;
+    }
+
+    const char *levelNames[] = {"scalar", "sse4.1", "avx2"};
+    int failures = 0;
+    std::vector<int> reference;
+    for (auto level : {simd::Level::SCALAR, simd::Level::SSE41, simd::Level::AVX2}) {
+        if (static_cast<int>(level) > static_cast<int>(simd::detected_level()))
+            break;
+        simd::set_level(level);
+        int mismatches = 0;
+        const auto scores = nnueScores(network, mismatches);
+        if (reference.empty())
+            reference = scores;
+        const bool sameAsScalar = scores == reference;
+        std::cout << "nnue/" << levelNames[static_cast<int>(level)] << ": "
+                  << scores.size() << " позиций, расхождений с пересчётом: "
+                  << mismatches << ", со скалярными ядрами: "
+                  << (sameAsScalar ? "нет" : "есть") << "\n";
+        if (mismatches != 0 || !sameAsScalar)
+            failures++;
+    }
+    simd::set_level(simd::detected_level());
+    return failures == 0 ? 0 : 1;
+}
+
+struct Measurement {
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+// Удваивает число повторов, пока замер не займёт minTime
+Measurement measure(const Benchmark &benchmark, std::chrono::nanoseconds minTime) {
+    using Clock = std::chrono::steady_clock;
+    benchmark.body(); // прогрев: кэши, ленивые таблицы
+
+    for (std::uint64_t calls = 1;; calls *= 2) {
+        const std::uint64_t allocations = allocationCount.load();
+        const std::uint64_t bytes = allocatedBytes.load();
+        const auto start = Clock::now();
+        for (std::uint64_t i = 0; i < calls; ++i)
+            benchmark.body();
+        const auto elapsed = Clock::now() - start;
+        if (elapsed < minTime && calls < (1ULL << 40))
+            continue;
+
+        const double ops = static_cast<double>(calls) *
+                           std::max(benchmark.opsPerCall, 1);
+        return {std::chrono::duration<double, std::nano>(elapsed).count() / ops,
+                (allocationCount.load() - allocations) / ops,
+                (allocatedBytes.load() - bytes) / ops};
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string filter;
+    long long minTimeMs = 200;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--min-time" && i + 1 < argc) {
+            minTimeMs = std::atoll(argv[++i]);
+        } else if (arg == "--check-nnue") {
+            return checkNnue();
+        } else if (arg == "--help") {
+            std::cout << "Использование: chess_bench [фильтр] [--min-time MS]\n"
+                         "               chess_bench --check-nnue\n";
+            return 0;
+        } else {
+            filter = arg;
+        }
+    }
+
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right
+              << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op"
+              << std::setw(12) << "bytes/op" << "\n";
+    std::cout << std::fixed;
+    for (const auto &benchmark : makeBenchmarks()) {
+        if (benchmark.name.find(filter) == std::string::npos)
+            continue;
+        const Measurement result =
+            measure(benchmark, std::chrono::milliseconds(minTimeMs));
+        std::cout << std::left << std::setw(40) << benchmark.name << std::right
+                  << std::setprecision(1) << std::setw(14) << result.nsPerOp
+                  << std::setprecision(2) << std::setw(12) << result.allocsPerOp
+                  << std::setprecision(0) << std::setw(12) << result.bytesPerOp
+                  << std::endl;
+    }
+    return 0;
+}
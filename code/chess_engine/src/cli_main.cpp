@@ -1,8 +1,12 @@
 #include "board/board.hpp"
+#include "board/position_history.hpp"
+#include "engine/bench.hpp"
 #include "engine/computer_player.hpp"
 #include "engine/move_generator.hpp" // Добавляем этот include
+#include "engine/nnue_evaluator.hpp"
 #include <algorithm>
 #include <cctype>
+#include <iomanip>
 #include <iostream>
 #include <memory> // Для std::make_unique
 #include <sstream>
@@ -11,16 +15,22 @@
 void printHelp() {
     std::cout
         << "Использование: chess_engine [--piece_type TYPE] [--computer]\n"
+        << "               chess_engine bench [хеш] [потоки] [глубина]\n"
         << "Доступные типы фигур:\n"
         << "  unicode  - Unicode символы (по умолчанию)\n"
         << "  letters  - Буквенные обозначения (K, Q, R и т.д.)\n"
         << "Опции:\n"
         << "  --computer - игра против компьютера (компьютер играет чёрными)\n"
+        << "  --eval-file FILE - оценивать позиции сетью NNUE из файла\n"
+        << "  --book FILE - дебютная книга (.txt или Polyglot .bin)\n"
         << "Команды во время игры:\n"
         << "  help h     - показать справку\n"
         << "  quit q     - выход\n"
         << "  reset r    - новая игра\n"
         << "  show [клетка] - показать ходы для фигуры (например, show e2)\n"
+        << "  analyze [N] [глубина] - N лучших вариантов (по умолчанию 3 и 4)\n"
+        << "  stats      - статистика последнего анализа в JSON\n"
+        << "  bench [хеш] [потоки] [глубина] - замер скорости на наборе позиций\n"
         << "  [откуда] [куда] - сделать ход (например, e2 e4)\n"
         << "  При превращении пешки добавьте тип фигуры (q, r, b, n): e7 e8 q\n"
         << "  Для выхода введите 'exit'\n";
@@ -41,6 +51,73 @@ chess::PieceType getPromotionType(char c) {
     }
 }
 
+std::string moveToString(const chess::engine::Move &move) {
+    return std::string(1, 'a' + move.from.first) +
+           std::to_string(8 - move.from.second) +
+           std::string(1, 'a' + move.to.first) +
+           std::to_string(8 - move.to.second);
+}
+
+// Board::print знает только о ничьих, видных по самой доске
+void printRepetition(const chess::Board &board,
+                     const chess::PositionHistory &history) {
+    if (history.is_repetition(board)) {
+        std::cout << "Ничья: позиция повторилась трижды\n";
+    }
+}
+
+// Несколько лучших вариантов с точными оценками (MultiPV), без книги.
+// Возвращает статистику поиска
+chess::engine::SearchStats analyzePosition(chess::engine::ComputerPlayer &computer,
+                                           const chess::Board &board,
+                                           const chess::PositionHistory &history,
+                                           const std::string &args) {
+    chess::engine::SearchLimits limits;
+    limits.multipv = 3;
+    limits.depth = 4;
+    std::istringstream iss(args);
+    int lines, depth;
+    if (iss >> lines && lines > 0) {
+        limits.multipv = lines;
+        if (iss >> depth && depth > 0)
+            limits.depth = depth;
+    }
+
+    chess::engine::SearchSignals signals;
+    chess::engine::SearchInfo last;
+    chess::Board position = board;
+    auto result = computer.generator().search(
+        position, board.current_player, history, limits, signals,
+        [&](const chess::engine::SearchInfo &info) { last = info; });
+    if (result.lines.empty()) {
+        std::cout << "Нет возможных ходов!\n";
+        return result.stats;
+    }
+
+    std::cout << "Глубина " << result.depth << ", узлов " << last.nodes
+              << ", " << last.time_ms << " мс\n";
+    for (size_t i = 0; i < result.lines.size(); ++i) {
+        const auto &line = result.lines[i];
+        std::cout << std::setw(3) << i + 1 << ". ";
+        // Мат: #3 - мат в 3 хода, #-2 - мат нам через 2 хода
+        if (chess::engine::is_mate_score(line.score)) {
+            std::cout << "#" << chess::engine::mate_in_moves(line.score) << " ";
+        } else {
+            std::cout << std::showpos << std::fixed << std::setprecision(2)
+                      << line.score / 100.0 << std::noshowpos << " ";
+        }
+        for (const auto &move : line.pv) {
+            std::cout << " " << moveToString(move);
+        }
+        std::cout << "\n";
+    }
+    // Подробные счётчики есть только в сборке с ENGINE_STATS
+    if (chess::engine::SearchStats::enabled) {
+        std::cout << "Статистика: " << result.stats.summary() << "\n";
+    }
+    return result.stats;
+}
+
 chess::PieceSet parsePieceSet(const std::string &type) {
     if (type == "unicode")
         return chess::PieceSet::UNICODE;
@@ -52,6 +129,15 @@ chess::PieceSet parsePieceSet(const std::string &type) {
 int main(int argc, char *argv[]) {
     chess::PieceSet pieceSet = chess::PieceSet::UNICODE;
     bool vsComputer = false;
+    std::string evalFile;
+
+    // chess_engine bench ... - только замер, без игры
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        std::string args;
+        for (int i = 2; i < argc; ++i)
+            args += std::string(argv[i]) + " ";
+        return chess::engine::run_bench_command(args, std::cerr);
+    }
 
     // Парсинг аргументов командной строки
     for (int i = 1; i < argc; ++i) {
@@ -62,6 +148,10 @@ int main(int argc, char *argv[]) {
             pieceSet = parsePieceSet(type);
         } else if (arg == "--computer") {
             vsComputer = true;
+        } else if (arg == "--eval-file" && i + 1 < argc) {
+            evalFile = argv[++i];
+        } else if (arg == "--book" && i + 1 < argc) {
+            chess::engine::OpeningBook::setSharedPath(argv[++i]);
         } else if (arg == "--help") {
             printHelp();
             return 0;
@@ -77,11 +167,27 @@ int main(int argc, char *argv[]) {
     SetConsoleOutputCP(CP_UTF8);
 #endif
 
+    // Книга грузится, пока человек думает над первым ходом
+    chess::engine::OpeningBook::preloadShared();
+
     chess::Board board;
+    // Позиции партии: по ним видно повторения
+    chess::PositionHistory history(board);
 
     // Создаём компьютерного игрока с генератором ходов
-    auto computer =
-        chess::engine::ComputerPlayer::create(chess::Color::BLACK, 3);
+    std::unique_ptr<chess::engine::Evaluator> evaluator;
+    if (!evalFile.empty()) {
+        try {
+            evaluator =
+                std::make_unique<chess::engine::NnueEvaluator>(evalFile);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    auto computer = chess::engine::ComputerPlayer::create(
+        chess::Color::BLACK, 3, std::move(evaluator));
+    chess::engine::SearchStats lastStats;
 
     printHelp();
     board.print();
@@ -100,8 +206,19 @@ int main(int argc, char *argv[]) {
                 break;
             } else if (input == "reset" || input == "r") {
                 board = chess::Board();
+                history.reset(board);
                 board.print();
                 continue;
+            } else if (input == "analyze" || input.rfind("analyze ", 0) == 0) {
+                lastStats = analyzePosition(*computer, board, history,
+                                            input.substr(7));
+                continue;
+            } else if (input == "bench" || input.rfind("bench ", 0) == 0) {
+                chess::engine::run_bench_command(input.substr(5), std::cerr);
+                continue;
+            } else if (input == "stats") {
+                std::cout << lastStats.to_json() << "\n";
+                continue;
             } else if (input.rfind("show ", 0) == 0) {
                 std::string coord = input.substr(5);
                 if (coord.length() != 2) {
@@ -152,7 +269,9 @@ int main(int argc, char *argv[]) {
             }
 
             if (board.make_move({fromX, fromY}, {toX, toY}, promoType)) {
+                history.push(board);
                 board.print();
+                printRepetition(board, history);
 
                 if (board.is_checkmate(chess::Color::BLACK)) {
                     std::cout << "Мат! Белые победили!\n";
@@ -167,12 +286,13 @@ int main(int argc, char *argv[]) {
             std::cout << "\nХод компьютера...\n";
             // std::this_thread::sleep_for(std::chrono::seconds(1));
 
-            if (!computer->makeMove(board)) {
+            if (!computer->makeMove(board, history)) {
                 std::cout << "У компьютера нет возможных ходов!\n";
                 break;
             }
 
             board.print();
+            printRepetition(board, history);
 
             if (board.is_checkmate(chess::Color::WHITE)) {
                 std::cout << "Мат! Чёрные победили!\n";
@@ -0,0 +1,49 @@
+#pragma once
+#include "engine/evaluator.hpp"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chess::engine {
+
+// Fixed-depth search over a built-in position suite. With one thread the
+// node total is deterministic: it is the engine's signature and must only
+// change with commits that change the search on purpose.
+struct BenchOptions {
+    std::size_t hash_mb = 16;
+    int threads = 1;
+    int depth = 4;
+};
+
+struct BenchResult {
+    std::uint64_t nodes = 0;
+    long long time_ms = 0;
+    // "go mate N" regression positions, run after the timed suite
+    int mate_checks = 0;
+    int mate_failures = 0;
+    std::uint64_t nps() const;
+};
+
+// "[hash] [threads] [depth]", any suffix may be omitted. Returns an
+// error message for malformed arguments, empty on success.
+std::string parse_bench_args(const std::string &args, BenchOptions &options);
+
+const std::vector<std::string> &bench_positions();
+
+// Searches every position with a fresh table and reports each one on
+// `out`. A null evaluator means PositionEvaluator.
+BenchResult run_bench(const BenchOptions &options, std::ostream &out,
+                      std::unique_ptr<Evaluator> evaluator = nullptr);
+
+// Final "Total time / Nodes searched / Nodes/second / Mates found" block
+void print_bench_result(const BenchResult &result, std::ostream &out);
+
+// The "bench [hash] [threads] [depth]" command of the front-ends: parses
+// `args`, runs the suite with its own generator and table and reports on
+// `out`. Returns the process exit code, non-zero on bad arguments or a
+// missed mate.
+int run_bench_command(const std::string &args, std::ostream &out);
+
+} // namespace chess::engine
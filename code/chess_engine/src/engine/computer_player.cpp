@@ -7,26 +7,53 @@ namespace chess::engine {
 
 ComputerPlayer::ComputerPlayer(Color color,
                                std::unique_ptr<MoveGenerator> generator)
-    : color_(color), generator_(std::move(generator)),
-      openingBook_("./assets/opening_book.txt") {}
+    : color_(color), generator_(std::move(generator)) {}
 
-bool ComputerPlayer::makeMove(Board &board) {
-    auto openingMove = openingBook_.getOpeningMove(board, color_);
+bool ComputerPlayer::makeMove(Board &board, PositionHistory &history) {
+    auto openingMove =
+        useBook_ ? OpeningBook::shared()->getOpeningMove(board, color_)
+                 : std::nullopt;
 
     if (openingMove) {
         lastMove_ = *openingMove;
     } else {
-        lastMove_ = generator_->generateBestMove(board, color_);
+        lastMove_ = generator_->generateBestMove(board, color_, history);
     }
 
-    return board.make_move(lastMove_.from, lastMove_.to);
+    if (!board.make_move(lastMove_.from, lastMove_.to, lastMove_.promotion))
+        return false;
+    history.push(board);
+    return true;
 }
 
 Move ComputerPlayer::getLastMove() const { return lastMove_; }
 
-std::unique_ptr<ComputerPlayer> ComputerPlayer::create(Color color,
-                                                       int difficulty) {
-    auto evaluator = std::make_unique<PositionEvaluator>();
+SearchResult ComputerPlayer::think(const Board &board,
+                                   const PositionHistory &history,
+                                   const SearchLimits &limits,
+                                   SearchSignals &signals,
+                                   const InfoCallback &info) {
+    const Color color = board.current_player;
+    auto openingMove =
+        useBook_ ? OpeningBook::shared()->getOpeningMove(board, color)
+                 : std::nullopt;
+    if (openingMove) {
+        SearchResult result;
+        result.best = *openingMove;
+        result.pv = {*openingMove};
+        return result;
+    }
+
+    Board position = board;
+    return generator_->search(position, color, history, limits, signals, info);
+}
+
+std::unique_ptr<ComputerPlayer>
+ComputerPlayer::create(Color color, int difficulty,
+                       std::unique_ptr<Evaluator> evaluator) {
+    if (!evaluator) {
+        evaluator = std::make_unique<PositionEvaluator>();
+    }
     auto generator =
         std::make_unique<MinimaxGenerator>(difficulty, std::move(evaluator));
     return std::make_unique<ComputerPlayer>(color, std::move(generator));
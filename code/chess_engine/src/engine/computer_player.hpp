@@ -1,4 +1,5 @@
 #pragma once
+#include "engine/evaluator.hpp"
 #include "engine/move_generator.hpp"
 #include "engine/opening_book.hpp"
 
@@ -7,17 +8,32 @@ namespace chess::engine {
 class ComputerPlayer {
   public:
     ComputerPlayer(Color color, std::unique_ptr<MoveGenerator> generator);
-    bool makeMove(Board &board);
+    // Делает ход на доске и добавляет новую позицию в history - историю
+    // партии, по которой поиск видит повторения
+    bool makeMove(Board &board, PositionHistory &history);
     Move getLastMove() const;
 
-    static std::unique_ptr<ComputerPlayer> create(Color color,
-                                                  int difficulty = 2);
+    // Лучший ход для стороны, которая ходит на доске, без его выполнения:
+    // книга, затем поиск в пределах limits. Можно вызывать из отдельного
+    // потока; остановка - через signals. Пустой pv - ходов нет.
+    SearchResult think(const Board &board, const PositionHistory &history,
+                       const SearchLimits &limits, SearchSignals &signals,
+                       const InfoCallback &info = {});
+
+    // Настройки движка (размер таблицы, потоки, оценщик) - между поисками
+    MoveGenerator &generator() { return *generator_; }
+    void setUseBook(bool useBook) { useBook_ = useBook; }
+
+    // Без оценщика используется PositionEvaluator
+    static std::unique_ptr<ComputerPlayer>
+    create(Color color, int difficulty = 2,
+           std::unique_ptr<Evaluator> evaluator = nullptr);
     Color color_;
 
   private:
     std::unique_ptr<MoveGenerator> generator_;
-    OpeningBook openingBook_;
     Move lastMove_;
+    bool useBook_ = true;
 };
 
 } // namespace chess::engine
@@ -0,0 +1,317 @@
+#include "engine/endgame.hpp"
+#include "board/geometry.hpp"
+#include "engine/position_evaluator.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace chess::engine {
+namespace {
+
+using geometry::file_of;
+using geometry::row_of;
+
+Color other(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+// Rank counted from `color`'s own back rank, 0..7
+int relative_rank(Color color, int square) {
+    return color == Color::WHITE ? 7 - row_of(square) : row_of(square);
+}
+
+int distance(int a, int b) { return geometry::DISTANCE[a][b]; }
+
+int manhattan(int a, int b) {
+    return std::abs(file_of(a) - file_of(b)) + std::abs(row_of(a) - row_of(b));
+}
+
+int find(const Board &board, PieceType type, Color color) {
+    const auto code = Piece(type, color).code();
+    const auto &codes = board.piece_codes();
+    for (int square = 0; square < 64; ++square) {
+        if (codes[square] == code)
+            return square;
+    }
+    return -1;
+}
+
+// KPK bitbase, built once by retrograde iteration. Positions are normalised
+// so the strong side moves up the board (rank 0 is its back rank) and the
+// pawn is on files a-d; squares here are rank * 8 + file.
+namespace kpk {
+
+enum Result : std::uint8_t { INVALID = 0, UNKNOWN = 1, DRAW = 2, WIN = 4 };
+
+// Strong side to move is 0, weak side 1; pawn ranks 1..6, files 0..3
+constexpr int SIZE = 2 * 24 * 64 * 64;
+
+int index(int side_to_move, int weak_king, int strong_king, int pawn) {
+    return strong_king | (weak_king << 6) | (side_to_move << 12) |
+           ((pawn % 8) << 13) | ((6 - pawn / 8) << 15);
+}
+
+std::uint64_t king_attacks(int square) {
+    return geometry::KING_ATTACKS[square];
+}
+
+// The bitbase pawn advances towards higher squares, as a black pawn does
+std::uint64_t pawn_attacks(int pawn) { return geometry::PAWN_ATTACKS[1][pawn]; }
+
+std::uint8_t initial(int side_to_move, int strong_king, int weak_king,
+                     int pawn) {
+    if (distance(strong_king, weak_king) <= 1 || strong_king == pawn ||
+        weak_king == pawn ||
+        (side_to_move == 0 && (pawn_attacks(pawn) & (1ULL << weak_king))))
+        return INVALID;
+
+    // Promotes and the new queen cannot be taken
+    const int queening = pawn + 8;
+    if (side_to_move == 0 && pawn / 8 == 6 && strong_king != queening &&
+        (distance(weak_king, queening) > 1 ||
+         distance(strong_king, queening) == 1))
+        return WIN;
+
+    // Stalemate, or the pawn can be taken for free
+    if (side_to_move == 1) {
+        const std::uint64_t moves = king_attacks(weak_king);
+        const std::uint64_t guarded =
+            king_attacks(strong_king) | pawn_attacks(pawn);
+        if ((moves & ~guarded) == 0 ||
+            (moves & ~king_attacks(strong_king) & (1ULL << pawn)))
+            return DRAW;
+    }
+    return UNKNOWN;
+}
+
+std::uint8_t classify(const std::vector<std::uint8_t> &db, int side_to_move,
+                      int strong_king, int weak_king, int pawn) {
+    const std::uint8_t good = side_to_move == 0 ? WIN : DRAW;
+    const std::uint8_t bad = side_to_move == 0 ? DRAW : WIN;
+    std::uint8_t reachable = INVALID;
+
+    std::uint64_t moves =
+        king_attacks(side_to_move == 0 ? strong_king : weak_king);
+    while (moves) {
+        const int to = __builtin_ctzll(moves);
+        moves &= moves - 1;
+        reachable |= side_to_move == 0 ? db[index(1, weak_king, to, pawn)]
+                                       : db[index(0, to, strong_king, pawn)];
+    }
+
+    if (side_to_move == 0 && pawn / 8 < 6) {
+        reachable |= db[index(1, weak_king, strong_king, pawn + 8)];
+        if (pawn / 8 == 1 && pawn + 8 != strong_king && pawn + 8 != weak_king)
+            reachable |= db[index(1, weak_king, strong_king, pawn + 16)];
+    }
+
+    if (reachable & good)
+        return good;
+    return (reachable & UNKNOWN) ? std::uint8_t{UNKNOWN} : bad;
+}
+
+const std::vector<bool> &wins() {
+    static const std::vector<bool> bitbase = [] {
+        std::vector<std::uint8_t> db(SIZE);
+        auto decode = [](int idx, int &side_to_move, int &strong_king,
+                         int &weak_king, int &pawn) {
+            strong_king = idx & 63;
+            weak_king = (idx >> 6) & 63;
+            side_to_move = (idx >> 12) & 1;
+            pawn = ((idx >> 13) & 3) + (6 - ((idx >> 15) & 7)) * 8;
+        };
+
+        int side_to_move, strong_king, weak_king, pawn;
+        for (int idx = 0; idx < SIZE; ++idx) {
+            decode(idx, side_to_move, strong_king, weak_king, pawn);
+            db[idx] = initial(side_to_move, strong_king, weak_king, pawn);
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int idx = 0; idx < SIZE; ++idx) {
+                if (db[idx] != UNKNOWN)
+                    continue;
+                decode(idx, side_to_move, strong_king, weak_king, pawn);
+                db[idx] =
+                    classify(db, side_to_move, strong_king, weak_king, pawn);
+                changed |= db[idx] != UNKNOWN;
+            }
+        }
+
+        std::vector<bool> result(SIZE);
+        for (int idx = 0; idx < SIZE; ++idx)
+            result[idx] = db[idx] == WIN;
+        return result;
+    }();
+    return bitbase;
+}
+
+} // namespace kpk
+
+int evaluate_draw(const Board &, Color) { return 0; }
+
+int evaluate_kpk(const Board &board, Color strong) {
+    const int pawn = find(board, PieceType::PAWN, strong);
+    const int strong_king = find(board, PieceType::KING, strong);
+    const int weak_king = find(board, PieceType::KING, other(strong));
+    if (!Endgames::kpk_is_win(strong, strong_king, pawn, weak_king,
+                              board.current_player))
+        return 0;
+    return Endgames::KNOWN_WIN + PositionEvaluator::PAWN_VALUE +
+           10 * relative_rank(strong, pawn);
+}
+
+// Drive the bare king into a corner of the bishop's colour and bring the
+// kings together
+int evaluate_kbnk(const Board &board, Color strong) {
+    const int strong_king = find(board, PieceType::KING, strong);
+    const int weak_king = find(board, PieceType::KING, other(strong));
+    // a8 and h1 are light, h8 and a1 dark
+    const bool light = board.light_bishops(strong) > 0;
+    const int corner_distance =
+        light ? std::min(manhattan(weak_king, 0), manhattan(weak_king, 63))
+              : std::min(manhattan(weak_king, 7), manhattan(weak_king, 56));
+
+    return Endgames::KNOWN_WIN + PositionEvaluator::KNIGHT_VALUE +
+           PositionEvaluator::BISHOP_VALUE + 20 * (14 - corner_distance) +
+           10 * (7 - distance(strong_king, weak_king));
+}
+
+// Rook against pawn: a win unless the pawn is far advanced, supported by its
+// king and the attacking king is too far away
+int evaluate_krkp(const Board &board, Color strong) {
+    const Color weak = other(strong);
+    const int strong_king = find(board, PieceType::KING, strong);
+    const int weak_king = find(board, PieceType::KING, weak);
+    const int rook = find(board, PieceType::ROOK, strong);
+    const int pawn = find(board, PieceType::PAWN, weak);
+
+    const int forward = weak == Color::WHITE ? -8 : 8;
+    const int queening = file_of(pawn) + (weak == Color::WHITE ? 0 : 56);
+    const int weak_tempo = board.current_player == weak ? 1 : 0;
+    const int strong_tempo = board.current_player == strong ? 1 : 0;
+
+    const bool king_in_front =
+        file_of(strong_king) == file_of(pawn) &&
+        relative_rank(weak, strong_king) > relative_rank(weak, pawn);
+    if (king_in_front)
+        return PositionEvaluator::ROOK_VALUE -
+               10 * distance(strong_king, pawn);
+
+    if (distance(weak_king, pawn) >= 3 + weak_tempo &&
+        distance(weak_king, rook) >= 3)
+        return PositionEvaluator::ROOK_VALUE -
+               10 * distance(strong_king, pawn);
+
+    if (relative_rank(strong, weak_king) <= 2 &&
+        distance(weak_king, pawn) == 1 &&
+        relative_rank(strong, strong_king) >= 3 &&
+        distance(strong_king, pawn) > 2 + strong_tempo)
+        return 80 - 8 * distance(strong_king, pawn);
+
+    const int stop = pawn + forward;
+    return 200 - 8 * (distance(strong_king, stop) - distance(weak_king, stop) -
+                      distance(pawn, queening));
+}
+
+// Opposite-coloured bishops with pawns: most of these are drawn
+int scale_opposite_bishops(const Board &board, Color) {
+    if (board.light_bishops(Color::WHITE) == board.light_bishops(Color::BLACK))
+        return Endgames::SCALE_NORMAL;
+    const int pawn_difference =
+        std::abs(board.piece_count(Color::WHITE, PieceType::PAWN) -
+                 board.piece_count(Color::BLACK, PieceType::PAWN));
+    return pawn_difference <= 1 ? Endgames::SCALE_NORMAL / 4
+                                : Endgames::SCALE_NORMAL / 2;
+}
+
+// Material key of the strong and weak side's pieces, kings implied
+std::uint64_t signature(const char *strong_pieces, const char *weak_pieces,
+                        Color strong) {
+    auto type_of = [](char letter) {
+        switch (letter) {
+        case 'P': return PieceType::PAWN;
+        case 'N': return PieceType::KNIGHT;
+        case 'B': return PieceType::BISHOP;
+        case 'R': return PieceType::ROOK;
+        default: return PieceType::QUEEN;
+        }
+    };
+    std::uint64_t key = 0;
+    for (const char *p = strong_pieces; *p; ++p)
+        key += 1ULL << Board::material_shift(strong, type_of(*p));
+    for (const char *p = weak_pieces; *p; ++p)
+        key += 1ULL << Board::material_shift(other(strong), type_of(*p));
+    return key;
+}
+
+} // namespace
+
+bool Endgames::kpk_is_win(Color strong, int strong_king, int pawn,
+                          int weak_king, Color side_to_move) {
+    const bool mirror = file_of(pawn) >= 4;
+    auto normalise = [&](int square) {
+        const int file = mirror ? 7 - file_of(square) : file_of(square);
+        return relative_rank(strong, square) * 8 + file;
+    };
+    const int stm = side_to_move == strong ? 0 : 1;
+    return kpk::wins()[kpk::index(stm, normalise(weak_king),
+                                  normalise(strong_king), normalise(pawn))];
+}
+
+const std::unordered_map<std::uint64_t, Endgames::Entry> &Endgames::table() {
+    static const auto entries = [] {
+        std::unordered_map<std::uint64_t, Entry> map;
+        auto add = [&](const char *strong, const char *weak, Entry entry) {
+            for (Color color : {Color::WHITE, Color::BLACK}) {
+                entry.strong = color;
+                map.emplace(signature(strong, weak, color), entry);
+            }
+        };
+
+        // Known draws
+        for (const auto &[strong, weak] :
+             {std::pair{"", ""}, {"N", ""}, {"B", ""}, {"NN", ""},
+              {"N", "N"}, {"B", "N"}, {"B", "B"}}) {
+            add(strong, weak, {Color::WHITE, &evaluate_draw, nullptr, true});
+        }
+
+        add("P", "", {Color::WHITE, &evaluate_kpk, nullptr, true});
+        add("BN", "", {Color::WHITE, &evaluate_kbnk, nullptr, false});
+        add("R", "P", {Color::WHITE, &evaluate_krkp, nullptr, false});
+
+        // One bishop each plus any pawns
+        const std::string pawns = "PPPPPPPP";
+        for (int own = 0; own <= 8; ++own) {
+            for (int their = 0; their <= 8; ++their) {
+                if (own + their == 0)
+                    continue;
+                const std::string strong = "B" + pawns.substr(0, own);
+                const std::string weak = "B" + pawns.substr(0, their);
+                add(strong.c_str(), weak.c_str(),
+                    {Color::WHITE, nullptr, &scale_opposite_bishops, false});
+            }
+        }
+        return map;
+    }();
+    return entries;
+}
+
+const Endgames::Entry *Endgames::probe(const Board &board) {
+    const auto &entries = table();
+    const auto it =
+        entries.find(board.material_key() & Board::MATERIAL_COUNTS_MASK);
+    return it == entries.end() ? nullptr : &it->second;
+}
+
+std::optional<int> Endgames::exact_score(const Board &board, Color color) {
+    const Entry *entry = probe(board);
+    if (!entry || !entry->exact)
+        return std::nullopt;
+    return score(*entry, board, color);
+}
+
+} // namespace chess::engine
@@ -0,0 +1,48 @@
+#pragma once
+#include "board/board.hpp"
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+namespace chess::engine {
+
+// Endgame knowledge indexed by Board::material_key(). A specialised
+// evaluator replaces the normal evaluation of its ending; a scale factor
+// pulls the normal evaluation towards a draw.
+class Endgames {
+  public:
+    static constexpr int SCALE_NORMAL = 64;
+    static constexpr int KNOWN_WIN = 1000;
+
+    // Both return values from the strong side's point of view
+    using EvaluateFn = int (*)(const Board &board, Color strong);
+    using ScaleFn = int (*)(const Board &board, Color strong);
+
+    struct Entry {
+        Color strong = Color::WHITE;
+        EvaluateFn evaluate = nullptr;
+        ScaleFn scale = nullptr;
+        bool exact = false; // the score is final, no search needed
+    };
+
+    static const Entry *probe(const Board &board);
+
+    // The entry's evaluate function, from `color`'s point of view
+    static int score(const Entry &entry, const Board &board, Color color) {
+        const int value = entry.evaluate(board, entry.strong);
+        return color == entry.strong ? value : -value;
+    }
+
+    // Score for `color` if it is final (known draws, KPK), so the search
+    // can stop at this node
+    static std::optional<int> exact_score(const Board &board, Color color);
+
+    // KPK bitbase lookup; squares are y * 8 + x as on the board
+    static bool kpk_is_win(Color strong, int strong_king, int pawn,
+                           int weak_king, Color side_to_move);
+
+  private:
+    static const std::unordered_map<std::uint64_t, Entry> &table();
+};
+
+} // namespace chess::engine
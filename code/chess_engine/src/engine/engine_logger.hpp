@@ -2,12 +2,17 @@
 #include "board/board.hpp"
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
 #include <vector>
 
 namespace chess::engine {
 
+// Root move scores of generateBestMove, printed to stderr when the search
+// ends (stdout carries the UCI protocol). Only ENGINE_DEBUG builds log;
+// otherwise the class is empty and the calls compile away.
+#ifdef ENGINE_DEBUG
 class DebugLogger {
   public:
     struct ScoredMove {
@@ -22,15 +27,16 @@ class DebugLogger {
 
     explicit DebugLogger(Color color)
         : color_(color), start_(std::chrono::steady_clock::now()) {
-        std::cout << "\n--- Engine Analysis ("
+        std::cerr << "\n--- Engine Analysis ("
                   << (color == Color::WHITE ? "White" : "Black") << ") ---\n";
     }
 
     void log_move(Position from, Position to, float score) {
         moves_.push_back({from, to, score / 100.0f});
-        nodes_++;
     }
 
+    void set_nodes(std::uint64_t nodes) { nodes_ = nodes; }
+
     ~DebugLogger() {
         auto end = std::chrono::steady_clock::now();
         auto duration =
@@ -38,21 +44,22 @@ class DebugLogger {
 
         std::sort(moves_.begin(), moves_.end());
 
-        std::cout << "Top moves:\n";
+        std::cerr << "Top moves:\n";
         const size_t count = std::min(size_t(3), moves_.size());
         for (size_t i = 0; i < count; ++i) {
             const auto &m = moves_[i];
-            std::cout << i + 1 << ". " << static_cast<char>('a' + m.from.first)
+            std::cerr << i + 1 << ". " << static_cast<char>('a' + m.from.first)
                       << (8 - m.from.second) << " → "
                       << static_cast<char>('a' + m.to.first)
                       << (8 - m.to.second) << " (";
 
             if (m.score >= 0)
-                std::cout << "+";
-            std::cout << std::fixed << std::setprecision(2) << m.score << ")\n";
+                std::cerr << "+";
+            std::cerr << std::fixed << std::setprecision(2) << m.score << ")\n";
         }
 
-        std::cout << "--------------------------------\n"
+        std::cerr << "--------------------------------\n"
+                  << "Root moves: " << moves_.size() << "\n"
                   << "Nodes: " << nodes_ << "\n"
                   << "Time: " << duration.count() << " ms\n"
                   << "--------------------------------\n";
@@ -61,7 +68,15 @@ class DebugLogger {
   private:
     Color color_;
     std::vector<ScoredMove> moves_;
-    size_t nodes_ = 0;
+    std::uint64_t nodes_ = 0;
     std::chrono::steady_clock::time_point start_;
 };
+#else
+class DebugLogger {
+  public:
+    explicit DebugLogger(Color) {}
+    void log_move(Position, Position, float) {}
+    void set_nodes(std::uint64_t) {}
+};
+#endif
 } // namespace chess::engine
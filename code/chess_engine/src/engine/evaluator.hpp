@@ -0,0 +1,38 @@
+#pragma once
+#include "board/board.hpp"
+#include <limits>
+#include <memory>
+
+namespace chess::engine {
+
+// Интерфейс оценщика позиции. Поиск держит его через unique_ptr, поэтому
+// оценщики можно подменять без изменения MinimaxGenerator.
+class Evaluator {
+  public:
+    static constexpr int MIN_SCORE = std::numeric_limits<int>::min();
+    static constexpr int MAX_SCORE = std::numeric_limits<int>::max();
+
+    virtual ~Evaluator() = default;
+
+    // A fresh evaluator with the same settings, for another search thread
+    virtual std::unique_ptr<Evaluator> clone() const = 0;
+
+    static Color opposite_color(Color c) {
+        return c == Color::WHITE ? Color::BLACK : Color::WHITE;
+    }
+
+    // Score of `board` from `color`'s point of view. The window is a hint:
+    // an evaluator may return early once the score is clearly outside it.
+    virtual int evaluate(const Board &board, Color color, int alpha = MIN_SCORE,
+                         int beta = MAX_SCORE) = 0;
+
+    // Search hooks for evaluators with incremental state: reset() at the
+    // root, push() after every move made, pop() when it is taken back and
+    // finish() when the search returns.
+    virtual void reset(const Board &) {}
+    virtual void push(const Board &, const Board &) {}
+    virtual void pop() {}
+    virtual void finish() {}
+};
+
+} // namespace chess::engine
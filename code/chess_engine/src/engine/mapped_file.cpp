@@ -0,0 +1,51 @@
+#include "engine/mapped_file.hpp"
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace chess::engine {
+
+MappedFile::MappedFile(const std::string &filename, bool sequential) {
+#ifdef _WIN32
+    (void)sequential;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        return;
+    buffer_.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info {};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        const auto length = static_cast<std::size_t>(info.st_size);
+        void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            if (sequential)
+                ::madvise(mapped, length, MADV_SEQUENTIAL);
+            data_ = static_cast<const unsigned char *>(mapped);
+            size_ = length;
+        }
+    }
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (data_)
+        ::munmap(const_cast<unsigned char *>(data_), size_);
+#endif
+}
+
+} // namespace chess::engine
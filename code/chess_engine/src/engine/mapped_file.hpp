@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace chess::engine {
+
+// Read-only view of a whole file: mmap on POSIX, a copy in memory on
+// Windows. Empty if the file cannot be opened.
+class MappedFile {
+  public:
+    // sequential hints the kernel to read ahead, for single-pass scans
+    explicit MappedFile(const std::string &filename, bool sequential = false);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const unsigned char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+  private:
+    const unsigned char *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    std::vector<unsigned char> buffer_;
+#endif
+};
+
+} // namespace chess::engine
@@ -1,8 +1,10 @@
 #include "engine/move_generator.hpp"
+#include "board/check_info.hpp"
+#include "board/zobrist.hpp"
+#include "engine/endgame.hpp"
 #include "engine/engine_logger.hpp"
 #include <algorithm>
 #include <chrono>
-#include <limits>
 #include <random>
 
 namespace chess::engine {
@@ -38,25 +40,113 @@ std::vector<Move> MoveGenerator::generateAllMoves(const Board &board,
 }
 
 MinimaxGenerator::MinimaxGenerator(int depth,
-                                   std::unique_ptr<PositionEvaluator> evaluator)
-    : depth_(depth), evaluator_(std::move(evaluator)) {}
+                                   std::unique_ptr<Evaluator> evaluator)
+    : MinimaxGenerator(depth, std::move(evaluator),
+                       std::make_shared<TranspositionTable>(), 0) {}
 
-Move MinimaxGenerator::generateBestMove(Board &board, Color color) {
+MinimaxGenerator::MinimaxGenerator(int depth,
+                                   std::unique_ptr<Evaluator> evaluator,
+                                   std::shared_ptr<TranspositionTable> tt,
+                                   int thread_index)
+    : depth_(depth), evaluator_(std::move(evaluator)), tt_(std::move(tt)),
+      thread_index_(thread_index) {}
+
+void MinimaxGenerator::set_threads(int threads) {
+    helpers_.clear();
+    for (int i = 1; i < threads; ++i) {
+        helpers_.push_back(std::unique_ptr<MinimaxGenerator>(
+            new MinimaxGenerator(depth_, evaluator_->clone(), tt_, i)));
+    }
+}
+
+void MinimaxGenerator::set_evaluator(std::unique_ptr<Evaluator> evaluator) {
+    evaluator_ = std::move(evaluator);
+    set_threads(static_cast<int>(helpers_.size()) + 1);
+}
+
+namespace {
+
+// Beyond any real score, and safe to negate
+constexpr int INFINITE_SCORE = 1000000;
+constexpr int DRAW_SCORE = 0;
+
+std::uint16_t encode(const Move &move) {
+    return static_cast<std::uint16_t>(
+        (move.from.second * 8 + move.from.first) * 64 + move.to.second * 8 +
+        move.to.first);
+}
+
+Move decode(std::uint16_t code) {
+    const int from = code / 64;
+    const int to = code % 64;
+    return {{from % 8, from / 8}, {to % 8, to / 8}};
+}
+
+// The table keeps mate scores as distance from the stored node, so they
+// stay right when the position is reached at another ply
+int score_to_tt(int score, int ply) {
+    if (score >= MATE_BOUND)
+        return score + ply;
+    if (score <= -MATE_BOUND)
+        return score - ply;
+    return score;
+}
+
+int score_from_tt(int score, int ply) {
+    if (score >= MATE_BOUND)
+        return score - ply;
+    if (score <= -MATE_BOUND)
+        return score + ply;
+    return score;
+}
+
+// Moves come as captures, best first, then quiet moves; this puts the
+// quiet moves that give check at the front of the quiet ones
+void order_quiet_checks(const Board &board, const CheckInfo &check_info,
+                        std::vector<Move> &moves) {
+    auto quiet = std::find_if(moves.begin(), moves.end(), [&](const Move &m) {
+        return board.get_piece(m.to).get_type() == PieceType::NONE;
+    });
+    std::stable_partition(quiet, moves.end(), [&](const Move &m) {
+        return check_info.gives_check(board, m);
+    });
+}
+
+bool same_move(const Move &a, const Move &b) {
+    return a.from == b.from && a.to == b.to;
+}
+
+} // namespace
+
+Move MinimaxGenerator::generateBestMove(Board &board, Color color,
+                                        const PositionHistory &history) {
     DebugLogger logger(color);
     auto moves = generateAllMoves(board, color);
     
     if (moves.empty()) return {{0, 0}, {0, 0}};
 
     Move best_move = moves[0];
-    int best_score = std::numeric_limits<int>::min();
+    int best_score = -INFINITE_SCORE;
+    evaluator_->reset(board);
+    tt_->new_search();
+    aborted_ = false;
+    nodes_ = 0;
+    root_depth_ = depth_;
+    root_color_ = color;
+    history_ = history;
+    if (history_.empty())
+        history_.reset(board);
     
     for (const auto &move : moves) {
         Board temp = board;
-        temp.make_move(move.from, move.to);
+        temp.apply_move(move);
+        evaluator_->push(board, temp);
+        history_.push(temp);
         
-        int score = minimax(temp, depth_ - 1, false, color,
-                           std::numeric_limits<int>::min(),
-                           std::numeric_limits<int>::max());
+        int score = -negamax<NodeType::PV>(temp, depth_ - 1, -INFINITE_SCORE,
+                                           INFINITE_SCORE, 1);
+        history_.pop();
+        evaluator_->pop();
         
         logger.log_move(move.from, move.to, score);
         
@@ -66,43 +156,428 @@ Move MinimaxGenerator::generateBestMove(Board &board, Color color) {
         }
     }
 
+    evaluator_->finish();
+    logger.set_nodes(nodes_);
     return best_move;
 }
 
-int MinimaxGenerator::minimax(Board &board, int depth, bool maximizing,
-                              Color eval_color, int alpha, int beta) {
-    if (depth == 0 || board.is_checkmate(eval_color) || board.is_draw()) {
-        return evaluator_->evaluate(board, eval_color);
+SearchResult MinimaxGenerator::search(Board &board, Color color,
+                                      const PositionHistory &history,
+                                      const SearchLimits &limits,
+                                      SearchSignals &signals,
+                                      const InfoCallback &info) {
+    SearchResult result;
+    auto moves = generateAllMoves(board, color);
+    if (moves.empty())
+        return result;
+
+    limits_ = &limits;
+    signals_ = &signals;
+    info_ = &info;
+    start_ = last_info_ = Clock::now();
+    nodes_ = 0;
+    stats_ = {};
+    aborted_ = false;
+    allocate_time(limits, color);
+    root_color_ = color;
+    history_ = history;
+    if (history_.empty())
+        history_.reset(board);
+    evaluator_->reset(board);
+    if (thread_index_ == 0) {
+        tt_->new_search();
+        start_helpers(board, color, history, limits);
     }
+    result.best = moves[0];
+    result.pv = {moves[0]};
+
+    int max_depth = MAX_PLY - 1;
+    if (limits.depth > 0)
+        max_depth = std::min(max_depth, limits.depth);
+    if (limits.mate > 0)
+        max_depth = std::min(max_depth, 2 * limits.mate - 1);
 
-    Color current_player = maximizing ? eval_color : PositionEvaluator::opposite_color(eval_color);
-    auto moves = generateAllMoves(board, current_player);
+    // Odd helpers skip the first iteration so the threads drift apart
+    const int line_count =
+        std::clamp(limits.multipv, 1, static_cast<int>(moves.size()));
+    for (int depth = 1 + thread_index_ % 2; depth <= max_depth; ++depth) {
+        seldepth_ = 0;
+        root_depth_ = depth;
+        std::vector<PvLine> lines;
 
-    if (maximizing) {
-        int max_eval = std::numeric_limits<int>::min();
-        for (const auto &move : moves) {
-            Board temp = board;
-            temp.make_move(move.from, move.to);
-            int eval = minimax(temp, depth - 1, false, eval_color, alpha, beta);
-            max_eval = std::max(max_eval, eval);
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha)
+        // Line k searches the root without the best moves of lines 0..k-1,
+        // which are kept at the front of `moves` in line order. The next
+        // iteration then tries them first.
+        for (int line = 0; line < line_count; ++line) {
+            int alpha = -INFINITE_SCORE;
+            int best_index = line;
+            int best_score = -INFINITE_SCORE;
+            pv_length_[0] = 0;
+
+            for (int i = line; i < static_cast<int>(moves.size()); ++i) {
+                const Move &move = moves[i];
+                Board temp = board;
+                temp.apply_move(move);
+                evaluator_->push(board, temp);
+                history_.push(temp);
+                // The root is a PV node: moves after the first are tried
+                // with a null window first
+                int score;
+                if (i == line) {
+                    score = -negamax<NodeType::PV>(temp, depth - 1,
+                                                   -INFINITE_SCORE, -alpha, 1);
+                } else {
+                    pv_length_[1] = 1;
+                    score = -negamax<NodeType::NON_PV>(temp, depth - 1,
+                                                       -alpha - 1, -alpha, 1);
+                    if (!aborted_ && score > alpha)
+                        score = -negamax<NodeType::PV>(
+                            temp, depth - 1, -INFINITE_SCORE, -alpha, 1);
+                }
+                history_.pop();
+                evaluator_->pop();
+                if (aborted_)
+                    break;
+
+                if (score > best_score) {
+                    best_score = score;
+                    best_index = i;
+                    update_pv(0, move);
+                }
+                alpha = std::max(alpha, score);
+            }
+            if (aborted_)
                 break;
+
+            std::rotate(moves.begin() + line, moves.begin() + best_index,
+                        moves.begin() + best_index + 1);
+            PvLine pv_line{best_score, {pv_[0].begin(),
+                                        pv_[0].begin() + pv_length_[0]}};
+            if (pv_line.pv.empty())
+                pv_line.pv.push_back(moves[line]);
+            extend_pv(board, pv_line.pv, depth);
+            lines.push_back(std::move(pv_line));
         }
-        return max_eval;
-    } else {
-        int min_eval = std::numeric_limits<int>::max();
-        for (const auto &move : moves) {
-            Board temp = board;
-            temp.make_move(move.from, move.to);
-            int eval = minimax(temp, depth - 1, true, eval_color, alpha, beta);
-            min_eval = std::min(min_eval, eval);
-            beta = std::min(beta, eval);
-            if (beta <= alpha)
-                break;
+        // An unfinished iteration is thrown away
+        if (aborted_)
+            break;
+
+        // Table hits can let a later line outscore an earlier one
+        std::stable_sort(lines.begin(), lines.end(),
+                         [](const PvLine &a, const PvLine &b) {
+                             return a.score > b.score;
+                         });
+        for (int line = 0; line < line_count; ++line) {
+            moves[line] = lines[line].pv[0];
+        }
+
+        stats_.seldepth = std::max(stats_.seldepth, seldepth_);
+        result.lines = std::move(lines);
+        result.best = result.lines[0].pv[0];
+        result.score = result.lines[0].score;
+        result.pv = result.lines[0].pv;
+        result.depth = depth;
+
+        if (info) {
+            for (int line = 0; line < line_count; ++line) {
+                SearchInfo line_info{depth, std::max(seldepth_, depth),
+                                     result.lines[line].score, total_nodes(),
+                                     elapsed_ms(), tt_->hashfull(),
+                                     result.lines[line].pv};
+                line_info.multipv = line + 1;
+                info(line_info);
+            }
         }
-        return min_eval;
+
+        // "go mate N": a mate within N moves needs no deeper search
+        if (limits.mate > 0 && result.score > 0 && is_mate_score(result.score) &&
+            mate_in_moves(result.score) <= limits.mate)
+            break;
+        // A new iteration would not finish in the time left
+        if (soft_limit_ms_ > 0 && !signals.ponder && elapsed_ms() >= soft_limit_ms_)
+            break;
+        if (signals.stop)
+            break;
+    }
+
+    stop_helpers();
+    evaluator_->finish();
+    stats_.nodes = nodes_;
+    result.stats = stats_;
+    for (const auto &helper : helpers_) {
+        result.stats.merge(helper->stats_);
+    }
+    limits_ = nullptr;
+    signals_ = nullptr;
+    info_ = nullptr;
+    return result;
+}
+
+void MinimaxGenerator::start_helpers(const Board &board, Color color,
+                                     const PositionHistory &history,
+                                     const SearchLimits &limits) {
+    // Helpers run until the main thread is done; only depth bounds them
+    helper_limits_ = SearchLimits{};
+    helper_limits_.depth = limits.depth;
+    helper_limits_.mate = limits.mate;
+    helper_limits_.infinite = true;
+    helper_signals_.stop = false;
+    helper_history_ = history;
+
+    // A helper clears its counters only once its thread runs; until then
+    // total_nodes() would still add the previous search
+    for (auto &helper : helpers_) {
+        helper->nodes_ = 0;
+        helper->stats_ = {};
+    }
+    for (auto &helper : helpers_) {
+        helper_threads_.emplace_back([this, &helper, board, color] {
+            Board position = board;
+            helper->search(position, color, helper_history_, helper_limits_,
+                           helper_signals_);
+        });
+    }
+}
+
+void MinimaxGenerator::stop_helpers() {
+    helper_signals_.stop = true;
+    for (auto &thread : helper_threads_) {
+        thread.join();
     }
+    helper_threads_.clear();
+}
+
+std::uint64_t MinimaxGenerator::total_nodes() const {
+    std::uint64_t nodes = nodes_.load(std::memory_order_relaxed);
+    for (const auto &helper : helpers_) {
+        nodes += helper->nodes_.load(std::memory_order_relaxed);
+    }
+    return nodes;
+}
+
+void MinimaxGenerator::allocate_time(const SearchLimits &limits, Color color) {
+    soft_limit_ms_ = hard_limit_ms_ = 0;
+    if (limits.infinite)
+        return;
+    if (limits.movetime > 0) {
+        soft_limit_ms_ = hard_limit_ms_ =
+            std::max(1, limits.movetime - limits.move_overhead);
+        return;
+    }
+
+    const int side = color == Color::WHITE ? 0 : 1;
+    if (limits.time[side] <= 0)
+        return;
+    const long long time_left =
+        std::max(1LL, static_cast<long long>(limits.time[side]) -
+                          limits.move_overhead);
+    // An even share of the remaining time plus most of the increment, never
+    // more than a third of the clock
+    const long long moves_left = limits.movestogo > 0 ? limits.movestogo : 30;
+    const long long budget = time_left / moves_left + limits.increment[side] * 3 / 4;
+    hard_limit_ms_ = std::max(1LL, std::min(budget, time_left / 3));
+    soft_limit_ms_ = hard_limit_ms_ / 2;
+}
+
+long long MinimaxGenerator::elapsed_ms() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                                 start_)
+        .count();
+}
+
+bool MinimaxGenerator::should_abort() {
+    if (aborted_)
+        return true;
+    const std::uint64_t nodes = nodes_.load(std::memory_order_relaxed) + 1;
+    nodes_.store(nodes, std::memory_order_relaxed);
+    // generateBestMove searches without limits
+    if (!limits_)
+        return false;
+
+    // Helpers have no node limit: the main thread stops them at the total
+    if (signals_->stop ||
+        (limits_->nodes > 0 && total_nodes() >= limits_->nodes)) {
+        aborted_ = true;
+        return true;
+    }
+    if (nodes % CHECK_INTERVAL != 0)
+        return false;
+
+    if (hard_limit_ms_ > 0 && !signals_->ponder && elapsed_ms() >= hard_limit_ms_) {
+        aborted_ = true;
+        return true;
+    }
+    // Keep the GUI informed during long iterations
+    const auto now = Clock::now();
+    if (*info_ && now - last_info_ >= std::chrono::seconds(1)) {
+        last_info_ = now;
+        (*info_)({0, seldepth_, 0, total_nodes(), elapsed_ms(),
+                  tt_->hashfull(), {}});
+    }
+    return false;
+}
+
+void MinimaxGenerator::update_pv(int ply, const Move &move) {
+    pv_[ply][ply] = move;
+    const int child_end = ply + 1 < MAX_PLY ? pv_length_[ply + 1] : ply + 1;
+    for (int i = ply + 1; i < child_end; ++i) {
+        pv_[ply][i] = pv_[ply + 1][i];
+    }
+    pv_length_[ply] = std::max(child_end, ply + 1);
+}
+
+void MinimaxGenerator::extend_pv(const Board &board, std::vector<Move> &pv,
+                                 int depth) {
+    // Table cutoffs cut the collected line short; follow the stored best
+    // moves for the rest
+    Board position = board;
+    for (const auto &move : pv) {
+        position.apply_move(move);
+    }
+    TranspositionTable::Entry entry;
+    while (static_cast<int>(pv.size()) < depth &&
+           tt_->probe(position.hash(), entry) && entry.move != 0) {
+        const Move move = decode(entry.move);
+        if (!position.is_legal(move))
+            break;
+        position.apply_move(move);
+        pv.push_back(move);
+    }
+}
+
+int MinimaxGenerator::evaluate(const Board &board, int alpha, int beta) {
+    // The evaluator is not symmetric, so the side to move reads the root
+    // side's score negated rather than getting one of its own
+    if (board.current_player == root_color_)
+        return evaluator_->evaluate(board, root_color_, alpha, beta);
+    return -evaluator_->evaluate(board, root_color_, -beta, -alpha);
+}
+
+template <MinimaxGenerator::NodeType Node>
+int MinimaxGenerator::negamax(Board &board, int depth, int alpha, int beta,
+                              int ply) {
+    constexpr bool pv_node = Node == NodeType::PV;
+    if constexpr (pv_node)
+        pv_length_[ply] = ply;
+    if (should_abort())
+        return 0;
+    seldepth_ = std::max(seldepth_, ply);
+
+    // Rule draws, known draws and bitbase results need no further search
+    if (board.is_search_draw(history_))
+        return DRAW_SCORE;
+    const Color us = board.current_player;
+    if (const auto known = Endgames::exact_score(board, us))
+        return *known;
+
+    if (depth == 0 || ply >= MAX_PLY - 1) {
+        // A leaf in check may be mate: the last move of a mate in N lands
+        // exactly on the horizon
+        if (board.is_check(us) && generateAllMoves(board, us).empty())
+            return -(MATE_SCORE - ply);
+        return evaluate(board, alpha, beta);
+    }
+
+    // Scores are from the side to move, as in the table
+    const std::uint64_t key = board.hash();
+#ifdef ENGINE_DEBUG
+    if (key != zobrist::hash(board))
+        std::cerr << "Incremental hash mismatch\n";
+#endif
+    TranspositionTable::Entry entry;
+    Move tt_move{};
+    bool has_tt_move = false;
+    ENGINE_STAT(++stats_.tt_probes);
+    if (tt_->probe(key, entry)) {
+        ENGINE_STAT(++stats_.tt_hits);
+        if (entry.move != 0) {
+            tt_move = decode(entry.move);
+            has_tt_move = true;
+        }
+        if (entry.depth >= depth) {
+            const int score = score_from_tt(entry.score, ply);
+            if (entry.bound == TranspositionTable::Bound::EXACT ||
+                (entry.bound == TranspositionTable::Bound::LOWER &&
+                 score >= beta) ||
+                (entry.bound == TranspositionTable::Bound::UPPER &&
+                 score <= alpha)) {
+                ENGINE_STAT(++stats_.tt_cutoffs);
+                return score;
+            }
+        }
+    }
+
+    // Legal moves are generated once; none left is mate or stalemate
+    auto moves = generateAllMoves(board, us);
+    if (moves.empty())
+        return board.is_check(us) ? -(MATE_SCORE - ply) : DRAW_SCORE;
+    // Quiet checks go right after the captures. Checks are also searched
+    // a ply deeper, as long as the line stays within twice the iteration
+    // depth.
+    const CheckInfo check_info(board);
+    order_quiet_checks(board, check_info, moves);
+    const bool extend_checks = ply < 2 * root_depth_;
+    if (has_tt_move) {
+        auto it = std::find_if(moves.begin(), moves.end(), [&](const Move &m) {
+            return same_move(m, tt_move);
+        });
+        if (it != moves.end())
+            std::rotate(moves.begin(), it, it + 1);
+    }
+
+    const int alpha_orig = alpha;
+    Move best_move{};
+    int best_score = -INFINITE_SCORE;
+    for (const auto &move : moves) {
+        const int extension =
+            extend_checks && check_info.gives_check(board, move) ? 1 : 0;
+        const int child_depth = depth - 1 + extension;
+        Board temp = board;
+        temp.apply_move(move);
+        evaluator_->push(board, temp);
+        history_.push(temp);
+        // Principal variation search: only the first move of a PV node
+        // gets the full window, the rest are proved worse with a null
+        // window and searched again if that fails
+        int score;
+        if (pv_node && &move == &moves.front()) {
+            score = -negamax<NodeType::PV>(temp, child_depth, -beta, -alpha,
+                                           ply + 1);
+        } else {
+            if constexpr (pv_node)
+                pv_length_[ply + 1] = ply + 1;
+            score = -negamax<NodeType::NON_PV>(temp, child_depth, -alpha - 1,
+                                               -alpha, ply + 1);
+            if (pv_node && !aborted_ && score > alpha && score < beta)
+                score = -negamax<NodeType::PV>(temp, child_depth, -beta,
+                                               -alpha, ply + 1);
+        }
+        history_.pop();
+        evaluator_->pop();
+        if (aborted_)
+            return 0;
+
+        if (score > best_score) {
+            best_score = score;
+            best_move = move;
+            if constexpr (pv_node)
+                update_pv(ply, move);
+        }
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) {
+            ENGINE_STAT(stats_.record_cutoff(&move == &moves.front()));
+            break;
+        }
+    }
+
+    auto bound = TranspositionTable::Bound::EXACT;
+    if (best_score <= alpha_orig)
+        bound = TranspositionTable::Bound::UPPER;
+    else if (best_score >= beta)
+        bound = TranspositionTable::Bound::LOWER;
+    tt_->store(key, depth, score_to_tt(best_score, ply), bound,
+               encode(best_move));
+    return best_score;
 }
 
 } // namespace chess::engine
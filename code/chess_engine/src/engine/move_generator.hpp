@@ -1,24 +1,41 @@
 #pragma once
 #include "board/board.hpp"
+#include "board/position_history.hpp"
+#include <algorithm>
 #include <map>
-#include "engine/position_evaluator.hpp"
+#include "engine/evaluator.hpp"
+#include "engine/search.hpp"
+#include "engine/transposition_table.hpp"
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <utility>
 #include <vector>
 
 namespace chess::engine {
 
-using Position = std::pair<int, int>;
-
-struct Move {
-    Position from;
-    Position to;
-};
-
 class MoveGenerator {
   public:
     virtual ~MoveGenerator() = default;
-    virtual Move generateBestMove(Board &board, Color color) = 0;
+    // `history` holds the game's positions up to `board`, so the search
+    // sees repetitions of them
+    virtual Move generateBestMove(Board &board, Color color,
+                                  const PositionHistory &history) = 0;
+    // Iterative deepening under `limits` until a limit is hit or
+    // signals.stop is set; may run on a thread of its own
+    virtual SearchResult search(Board &board, Color color,
+                                const PositionHistory &history,
+                                const SearchLimits &limits,
+                                SearchSignals &signals,
+                                const InfoCallback &info = {}) = 0;
+
+    // Engine settings, applied between searches. Generators without a
+    // table or helper threads ignore them.
+    virtual void set_hash_size(std::size_t) {}
+    virtual void clear_hash() {}
+    virtual void set_threads(int) {}
+    virtual void set_evaluator(std::unique_ptr<Evaluator>) {}
     std::vector<Move> generateAllMoves(const Board &board, Color color);
 
     int getMVVLVAscore(const Board &board, const Move &move) {
@@ -55,15 +72,80 @@ protected:
 
 class MinimaxGenerator : public MoveGenerator {
   public:
-    MinimaxGenerator(int depth, std::unique_ptr<PositionEvaluator> evaluator);
-    Move generateBestMove(Board &board, Color color) override;
+    MinimaxGenerator(int depth, std::unique_ptr<Evaluator> evaluator);
+    Move generateBestMove(Board &board, Color color,
+                          const PositionHistory &history) override;
+    SearchResult search(Board &board, Color color,
+                        const PositionHistory &history,
+                        const SearchLimits &limits, SearchSignals &signals,
+                        const InfoCallback &info = {}) override;
+
+    void set_hash_size(std::size_t size_mb) override { tt_->resize(size_mb); }
+    void clear_hash() override { tt_->clear(); }
+    // Lazy SMP: helper threads search the same root and share the table
+    void set_threads(int threads) override;
+    void set_evaluator(std::unique_ptr<Evaluator> evaluator) override;
+
+    TranspositionTable &transposition_table() { return *tt_; }
 
   private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int MAX_PLY = 64;
+    static constexpr int CHECK_INTERVAL = 1024; // nodes between limit checks
+
     int depth_;
-    std::unique_ptr<PositionEvaluator> evaluator_;
+    std::unique_ptr<Evaluator> evaluator_;
+    std::shared_ptr<TranspositionTable> tt_;
+
+    // Helper threads of the main generator; thread_index_ is 0 for it
+    int thread_index_ = 0;
+    std::vector<std::unique_ptr<MinimaxGenerator>> helpers_;
+    std::vector<std::thread> helper_threads_;
+    SearchSignals helper_signals_;
+    SearchLimits helper_limits_;
+    PositionHistory helper_history_;
+
+    // State of the running search
+    const SearchLimits *limits_ = nullptr;
+    SearchSignals *signals_ = nullptr;
+    const InfoCallback *info_ = nullptr;
+    Clock::time_point start_;
+    Clock::time_point last_info_;
+    long long soft_limit_ms_ = 0; // no new iteration after this
+    long long hard_limit_ms_ = 0; // 0: no time limit
+    std::atomic<std::uint64_t> nodes_{0}; // read by the main thread
+    int seldepth_ = 0;                    // of the current iteration
+    int root_depth_ = 0;                  // nominal depth of the iteration
+    Color root_color_ = Color::WHITE;     // the evaluator's point of view
+    SearchStats stats_;
+    bool aborted_ = false;
+    // The game's positions followed by the line being searched
+    PositionHistory history_;
+    std::array<std::array<Move, MAX_PLY>, MAX_PLY> pv_{};
+    std::array<int, MAX_PLY> pv_length_{};
+
+    MinimaxGenerator(int depth, std::unique_ptr<Evaluator> evaluator,
+                     std::shared_ptr<TranspositionTable> tt, int thread_index);
+
+    // PV nodes are searched with an open window and keep the principal
+    // variation; all others only need to prove a score is below alpha
+    enum class NodeType { PV, NON_PV };
 
-    int minimax(Board &board, int depth, bool maximizing, Color eval_color,
-                int alpha, int beta);
+    // Scores are from the side to move's point of view
+    template <NodeType Node>
+    int negamax(Board &board, int depth, int alpha, int beta, int ply);
+    int evaluate(const Board &board, int alpha, int beta);
+    void start_helpers(const Board &board, Color color,
+                       const PositionHistory &history,
+                       const SearchLimits &limits);
+    void stop_helpers();
+    std::uint64_t total_nodes() const;
+    // Counts the node and checks stop, node and time limits
+    bool should_abort();
+    long long elapsed_ms() const;
+    void allocate_time(const SearchLimits &limits, Color color);
+    void update_pv(int ply, const Move &move);
+    void extend_pv(const Board &board, std::vector<Move> &pv, int depth);
 };
 
 } // namespace chess::engine
@@ -0,0 +1,369 @@
+#include "engine/nnue_evaluator.hpp"
+#include "engine/simd.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace chess::engine {
+namespace {
+
+constexpr char NNUE_MAGIC[8] = {'E', 'C', 'B', 'N', 'N', 'U', 'E', '1'};
+
+int square_index(int x, int y) { return (7 - y) * 8 + x; }
+
+bool is_feature(const Piece &piece) {
+    return piece.get_type() >= PieceType::PAWN &&
+           piece.get_type() <= PieceType::QUEEN;
+}
+
+// Squares are mirrored for black so each side sees its own king at the
+// bottom of the board.
+int feature_index(Color perspective, int king_square, const Piece &piece,
+                  int square) {
+    if (perspective == Color::BLACK) {
+        king_square ^= 56;
+        square ^= 56;
+    }
+    int kind = (static_cast<int>(piece.get_type()) - 1) * 2 +
+               (piece.get_color() == perspective ? 0 : 1);
+    return (king_square * NnueNetwork::PIECE_KINDS + kind) * 64 + square;
+}
+
+// Accumulator kernels
+
+void add_row_scalar(std::int16_t *acc, const std::int16_t *row, int n) {
+    for (int i = 0; i < n; ++i)
+        acc[i] += row[i];
+}
+
+void sub_row_scalar(std::int16_t *acc, const std::int16_t *row, int n) {
+    for (int i = 0; i < n; ++i)
+        acc[i] -= row[i];
+}
+
+std::int32_t dot_scalar(const std::int16_t *acc, const std::int16_t *weights,
+                        int n) {
+    std::int32_t sum = 0;
+    for (int i = 0; i < n; ++i) {
+        int value = std::clamp<int>(acc[i], 0, NnueNetwork::ACTIVATION_LIMIT);
+        sum += value * weights[i];
+    }
+    return sum;
+}
+
+#ifdef ENGINE_X86_SIMD
+ENGINE_TARGET("avx2")
+void add_row_avx2(std::int16_t *acc, const std::int16_t *row, int n) {
+    for (int i = 0; i < n; i += 16) {
+        auto *dst = reinterpret_cast<__m256i *>(acc + i);
+        __m256i a = _mm256_loadu_si256(dst);
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+        _mm256_storeu_si256(dst, _mm256_add_epi16(a, b));
+    }
+}
+
+ENGINE_TARGET("avx2")
+void sub_row_avx2(std::int16_t *acc, const std::int16_t *row, int n) {
+    for (int i = 0; i < n; i += 16) {
+        auto *dst = reinterpret_cast<__m256i *>(acc + i);
+        __m256i a = _mm256_loadu_si256(dst);
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+        _mm256_storeu_si256(dst, _mm256_sub_epi16(a, b));
+    }
+}
+
+ENGINE_TARGET("avx2")
+std::int32_t dot_avx2(const std::int16_t *acc, const std::int16_t *weights,
+                      int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i limit = _mm256_set1_epi16(NnueNetwork::ACTIVATION_LIMIT);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc + i));
+        __m256i w =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), limit);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, w));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                 _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+}
+
+ENGINE_TARGET("sse4.1")
+void add_row_sse41(std::int16_t *acc, const std::int16_t *row, int n) {
+    for (int i = 0; i < n; i += 8) {
+        auto *dst = reinterpret_cast<__m128i *>(acc + i);
+        __m128i a = _mm_loadu_si128(dst);
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        _mm_storeu_si128(dst, _mm_add_epi16(a, b));
+    }
+}
+
+ENGINE_TARGET("sse4.1")
+void sub_row_sse41(std::int16_t *acc, const std::int16_t *row, int n) {
+    for (int i = 0; i < n; i += 8) {
+        auto *dst = reinterpret_cast<__m128i *>(acc + i);
+        __m128i a = _mm_loadu_si128(dst);
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        _mm_storeu_si128(dst, _mm_sub_epi16(a, b));
+    }
+}
+
+ENGINE_TARGET("sse4.1")
+std::int32_t dot_sse41(const std::int16_t *acc, const std::int16_t *weights,
+                       int n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i limit = _mm_set1_epi16(NnueNetwork::ACTIVATION_LIMIT);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + i));
+        __m128i w =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+        a = _mm_min_epi16(_mm_max_epi16(a, zero), limit);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, w));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+void add_row(std::int16_t *acc, const std::int16_t *row, int n) {
+#ifdef ENGINE_X86_SIMD
+    switch (simd::level()) {
+        case simd::Level::AVX2:
+            return add_row_avx2(acc, row, n);
+        case simd::Level::SSE41:
+            return add_row_sse41(acc, row, n);
+        default:
+            break;
+    }
+#endif
+    add_row_scalar(acc, row, n);
+}
+
+void sub_row(std::int16_t *acc, const std::int16_t *row, int n) {
+#ifdef ENGINE_X86_SIMD
+    switch (simd::level()) {
+        case simd::Level::AVX2:
+            return sub_row_avx2(acc, row, n);
+        case simd::Level::SSE41:
+            return sub_row_sse41(acc, row, n);
+        default:
+            break;
+    }
+#endif
+    sub_row_scalar(acc, row, n);
+}
+
+std::int32_t dot(const std::int16_t *acc, const std::int16_t *weights, int n) {
+#ifdef ENGINE_X86_SIMD
+    switch (simd::level()) {
+        case simd::Level::AVX2:
+            return dot_avx2(acc, weights, n);
+        case simd::Level::SSE41:
+            return dot_sse41(acc, weights, n);
+        default:
+            break;
+    }
+#endif
+    return dot_scalar(acc, weights, n);
+}
+
+template <typename T>
+void read_values(std::ifstream &file, std::vector<T> &values, size_t count) {
+    values.resize(count);
+    file.read(reinterpret_cast<char *>(values.data()), count * sizeof(T));
+}
+
+} // namespace
+
+std::shared_ptr<const NnueNetwork> NnueNetwork::load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open NNUE file: " + path);
+    }
+
+    char magic[8];
+    std::uint32_t hidden = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&hidden), sizeof(hidden));
+    if (!file || std::memcmp(magic, NNUE_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not an NNUE network file: " + path);
+    }
+    if (hidden == 0 || hidden % 16 != 0 || hidden > MAX_HIDDEN) {
+        throw std::runtime_error("Unsupported NNUE hidden size in " + path);
+    }
+
+    auto network = std::make_shared<NnueNetwork>();
+    network->hidden = static_cast<int>(hidden);
+    read_values(file, network->feature_biases, hidden);
+    read_values(file, network->feature_weights,
+                static_cast<size_t>(INPUTS) * hidden);
+    read_values(file, network->output_weights, 2 * hidden);
+    file.read(reinterpret_cast<char *>(&network->output_bias),
+              sizeof(network->output_bias));
+
+    if (!file) {
+        throw std::runtime_error("Truncated NNUE file: " + path);
+    }
+    if (!network->output_fits_int32()) {
+        throw std::runtime_error("NNUE output weights overflow int32 in " +
+                                 path);
+    }
+    return network;
+}
+
+bool NnueNetwork::output_fits_int32() const {
+    // Lanes of the vector kernels hold partial sums, which are bounded by
+    // the same total
+    for (int half = 0; half < 2; ++half) {
+        std::int64_t bound = 0;
+        for (int i = 0; i < hidden; ++i)
+            bound += std::abs(output_weights[half * hidden + i]);
+        if (bound * ACTIVATION_LIMIT > std::numeric_limits<std::int32_t>::max())
+            return false;
+    }
+    return true;
+}
+
+NnueEvaluator::NnueEvaluator(const std::string &network_path)
+    : NnueEvaluator(NnueNetwork::load(network_path)) {}
+
+NnueEvaluator::NnueEvaluator(std::shared_ptr<const NnueNetwork> network)
+    : network_(std::move(network)) {}
+
+std::int16_t *NnueEvaluator::accumulator(int ply, Color perspective) {
+    const size_t hidden = network_->hidden;
+    const size_t needed = (ply + 1) * 2 * hidden;
+    if (stack_.size() < needed) {
+        stack_.resize(needed);
+    }
+    return stack_.data() + (ply * 2 + (perspective == Color::WHITE ? 0 : 1)) *
+                               hidden;
+}
+
+void NnueEvaluator::refresh(const Board &board, Color perspective,
+                            std::int16_t *acc) const {
+    const int hidden = network_->hidden;
+    std::copy_n(network_->feature_biases.data(), hidden, acc);
+
+    Position king = board.find_king(perspective);
+    const int king_square = square_index(king.first, king.second);
+
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            const auto &piece = board.get_piece({x, y});
+            if (!is_feature(piece))
+                continue;
+            int feature = feature_index(perspective, king_square, piece,
+                                        square_index(x, y));
+            add_row(acc,
+                    network_->feature_weights.data() +
+                        static_cast<size_t>(feature) * hidden,
+                    hidden);
+        }
+    }
+}
+
+void NnueEvaluator::reset(const Board &root) {
+    ply_ = 0;
+    refresh(root, Color::WHITE, accumulator(0, Color::WHITE));
+    refresh(root, Color::BLACK, accumulator(0, Color::BLACK));
+}
+
+void NnueEvaluator::push(const Board &before, const Board &after) {
+    if (ply_ < 0) {
+        reset(before);
+    }
+
+    const int hidden = network_->hidden;
+    const std::int16_t *weights = network_->feature_weights.data();
+    accumulator(ply_ + 1, Color::WHITE); // grow the stack before taking pointers
+
+    for (Color perspective : {Color::WHITE, Color::BLACK}) {
+        std::int16_t *parent = accumulator(ply_, perspective);
+        std::int16_t *child = accumulator(ply_ + 1, perspective);
+
+        Position king_before = before.find_king(perspective);
+        Position king_after = after.find_king(perspective);
+        if (king_before != king_after) {
+            // Every feature depends on the king square: start over
+            refresh(after, perspective, child);
+            continue;
+        }
+
+        std::copy_n(parent, hidden, child);
+        const int king_square = square_index(king_after.first, king_after.second);
+        for (int y = 0; y < 8; ++y) {
+            for (int x = 0; x < 8; ++x) {
+                const auto &old_piece = before.get_piece({x, y});
+                const auto &new_piece = after.get_piece({x, y});
+                if (old_piece.get_type() == new_piece.get_type() &&
+                    old_piece.get_color() == new_piece.get_color())
+                    continue;
+
+                const int square = square_index(x, y);
+                if (is_feature(old_piece)) {
+                    int feature = feature_index(perspective, king_square,
+                                                old_piece, square);
+                    sub_row(child, weights + static_cast<size_t>(feature) * hidden,
+                            hidden);
+                }
+                if (is_feature(new_piece)) {
+                    int feature = feature_index(perspective, king_square,
+                                                new_piece, square);
+                    add_row(child, weights + static_cast<size_t>(feature) * hidden,
+                            hidden);
+                }
+            }
+        }
+    }
+    ply_++;
+}
+
+void NnueEvaluator::pop() {
+    if (ply_ > 0) {
+        ply_--;
+    }
+}
+
+void NnueEvaluator::finish() {
+    // The root accumulator belongs to the finished search
+    ply_ = -1;
+}
+
+int NnueEvaluator::output(const std::int16_t *us,
+                          const std::int16_t *them) const {
+    const int hidden = network_->hidden;
+    const std::int16_t *weights = network_->output_weights.data();
+    std::int64_t sum = static_cast<std::int64_t>(dot(us, weights, hidden)) +
+                       dot(them, weights + hidden, hidden) +
+                       network_->output_bias;
+    return static_cast<int>(sum * NnueNetwork::EVAL_SCALE /
+                            (NnueNetwork::ACTIVATION_LIMIT *
+                             NnueNetwork::OUTPUT_SCALE));
+}
+
+int NnueEvaluator::evaluate(const Board &board, Color color, int, int) {
+    int ply = ply_;
+    if (ply < 0) {
+        // Outside a search: score from scratch and keep no state
+        ply = 0;
+        refresh(board, Color::WHITE, accumulator(0, Color::WHITE));
+        refresh(board, Color::BLACK, accumulator(0, Color::BLACK));
+    }
+
+    const Color side = board.current_player;
+    int score = output(accumulator(ply, side),
+                       accumulator(ply, opposite_color(side)));
+    return color == side ? score : -score;
+}
+
+} // namespace chess::engine
@@ -0,0 +1,80 @@
+#pragma once
+#include "engine/evaluator.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace chess::engine {
+
+// Quantized HalfKP-style network. Every (own king square, piece, square)
+// feature of a perspective adds one int16 weight row to that perspective's
+// accumulator; both accumulators go through a clipped ReLU into a single
+// output neuron, side to move first.
+//
+// File layout (little-endian):
+//   char[8]  "ECBNNUE1"
+//   uint32   hidden size, a multiple of 16 up to MAX_HIDDEN
+//   int16    feature biases  [hidden]
+//   int16    feature weights [INPUTS][hidden]
+//   int16    output weights  [2][hidden]
+//   int32    output bias
+//
+// Integer ranges: accumulators are int16, so a bias plus the rows of the
+// up to 30 features of a position must stay within int16 (overflow wraps,
+// the same way in every kernel). Each output half is summed in int32 over
+// activations in [0, ACTIVATION_LIMIT], which cannot overflow while
+// ACTIVATION_LIMIT * sum(|weight|) of the half fits in int32; load()
+// rejects networks that break this.
+struct NnueNetwork {
+    static constexpr int PIECE_KINDS = 10; // P N B R Q for either side
+    static constexpr int INPUTS = 64 * PIECE_KINDS * 64;
+    static constexpr int MAX_HIDDEN = 1024;
+    static constexpr int ACTIVATION_LIMIT = 255;
+    static constexpr int OUTPUT_SCALE = 64;
+    static constexpr int EVAL_SCALE = 400;
+
+    int hidden = 0;
+    std::vector<std::int16_t> feature_biases;
+    std::vector<std::int16_t> feature_weights;
+    std::vector<std::int16_t> output_weights;
+    std::int32_t output_bias = 0;
+
+    // True when neither output half can overflow its int32 sum
+    bool output_fits_int32() const;
+
+    // Throws std::runtime_error if the file is missing or malformed
+    static std::shared_ptr<const NnueNetwork> load(const std::string &path);
+};
+
+class NnueEvaluator : public Evaluator {
+  public:
+    explicit NnueEvaluator(const std::string &network_path);
+    explicit NnueEvaluator(std::shared_ptr<const NnueNetwork> network);
+
+    int evaluate(const Board &board, Color color, int alpha = MIN_SCORE,
+                 int beta = MAX_SCORE) override;
+    // Shares the network; the accumulators are per evaluator
+    std::unique_ptr<Evaluator> clone() const override {
+        return std::make_unique<NnueEvaluator>(network_);
+    }
+
+    void reset(const Board &root) override;
+    void push(const Board &before, const Board &after) override;
+    void pop() override;
+    void finish() override;
+
+  private:
+    std::shared_ptr<const NnueNetwork> network_;
+
+    // One entry per ply, each holding the white and black accumulators
+    std::vector<std::int16_t> stack_;
+    int ply_ = -1;
+
+    std::int16_t *accumulator(int ply, Color perspective);
+    void refresh(const Board &board, Color perspective,
+                 std::int16_t *acc) const;
+    int output(const std::int16_t *us, const std::int16_t *them) const;
+};
+
+} // namespace chess::engine
@@ -1,15 +1,81 @@
 #include "engine/opening_book.hpp"
 #include "board/initialization.hpp"
+#include "board/zobrist.hpp"
 #include "pieces/piece.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
+#include <future>
 #include <iostream> // не забудь добавить, если ещё нет
+#include <mutex>
 #include <random>
 #include <sstream>
 
+#ifndef ENGINE_ASSETS_DIR
+#define ENGINE_ASSETS_DIR "./assets"
+#endif
+
 namespace chess::engine {
 
+namespace {
+
+struct SharedBook {
+    std::mutex mutex;
+    std::string path;
+    std::shared_ptr<const OpeningBook> book;
+};
+
+SharedBook &sharedBook() {
+    static SharedBook state;
+    return state;
+}
+
+} // namespace
+
+std::shared_ptr<const OpeningBook> OpeningBook::shared() {
+    auto &state = sharedBook();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.book) {
+        // Остальные потоки ждут на мьютексе, пока книга грузится
+        state.book = std::make_shared<const OpeningBook>(
+            state.path.empty() ? defaultPath() : state.path);
+    }
+    return state.book;
+}
+
+void OpeningBook::setSharedPath(const std::string &path) {
+    auto &state = sharedBook();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (path != state.path) {
+        state.path = path;
+        state.book.reset();
+    }
+}
+
+std::string OpeningBook::sharedPath() {
+    auto &state = sharedBook();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.path.empty() ? defaultPath() : state.path;
+}
+
+void OpeningBook::preloadShared() {
+    // Деструктор future дождётся окончания предыдущей загрузки (и загрузки
+    // при выходе из программы)
+    static std::mutex mutex;
+    static std::future<void> loading;
+    std::lock_guard<std::mutex> lock(mutex);
+    loading = std::async(std::launch::async, [] { shared(); });
+}
+
+std::string OpeningBook::defaultPath() {
+    if (const char *path = std::getenv("CHESS_BOOK_FILE")) {
+        if (*path)
+            return path;
+    }
+    return std::string(ENGINE_ASSETS_DIR) + "/opening_book.txt";
+}
+
 std::optional<Move> OpeningBook::parseMove(const std::string &moveStr) {
     if (moveStr.size() < 4)
         return std::nullopt;
@@ -38,6 +104,21 @@ std::optional<Move> OpeningBook::parseMove(const std::string &moveStr) {
 }
 
 OpeningBook::OpeningBook(const std::string &filename) {
+    const std::string binaryExtension = ".bin";
+    if (filename.size() >= binaryExtension.size() &&
+        filename.compare(filename.size() - binaryExtension.size(),
+                         binaryExtension.size(), binaryExtension) == 0) {
+        binary_ = std::make_unique<PolyglotBook>(filename);
+        // Книга с ключами Random64 из Polyglot: поиск в ней всегда промахнётся
+        if (binary_->foreign_keys()) {
+            std::cerr << "OpeningBook: " << filename
+                      << " построена на других ключах Zobrist,"
+                      << " книга не используется\n";
+            binary_.reset();
+        }
+        return;
+    }
+
     std::ifstream file(filename);
     if (!file.is_open()) {
         // Можно кидать исключение или логировать ошибку
@@ -68,31 +149,56 @@ OpeningBook::OpeningBook(const std::string &filename) {
     }
 }
 
-std::string replaceEnPassant(std::string fen) {
-    if (fen.size() >= 2) {
-        // заменим последние два символа на " -"
-        fen.replace(fen.size() - 2, 2, "-");
+std::string_view OpeningBook::positionKey(const Board &board,
+                                          BoardInitializer::FenBuffer &buffer) {
+    std::string_view key = BoardInitializer::write_fen(board, buffer);
+    // Отрезаем два последних поля (halfmove clock и fullmove number)
+    key = key.substr(0, key.rfind(' '));
+    key = key.substr(0, key.rfind(' '));
+    // В книге поле взятия на проходе указано, только если взятие возможно
+    if (board.en_passant_target() && !zobrist::en_passant_capturable(board)) {
+        buffer[key.size() - 2] = '-';
+        key.remove_suffix(1);
     }
-    return fen;
+    return key;
+}
+
+std::string OpeningBook::positionKey(const Board &board) {
+    BoardInitializer::FenBuffer buffer;
+    return std::string(positionKey(board, buffer));
 }
 
 std::optional<Move> OpeningBook::getOpeningMove(const Board &board,
                                                 Color color) const {
-    std::string fen = BoardInitializer::export_to_fen(board);
+    if (binary_) {
+        std::vector<std::pair<Move, int>> moves;
+        for (const auto &entry : binary_->find(board.hash())) {
+            moves.emplace_back(PolyglotBook::decode_move(board, entry.move),
+                               entry.weight);
+        }
+        return pickMove(moves);
+    }
+
     // std::string fen = boardToFEN(board, color);
-    std::string key = removeMoveCounters(fen);
-    key = replaceEnPassant(key);
+    BoardInitializer::FenBuffer buffer;
+    std::string_view key = positionKey(board, buffer);
 
     // std::cerr << key << '\n';
 
     auto it = book_.find(key);
 
-    if (it == book_.end() || it->second.empty())
+    if (it == book_.end())
         return std::nullopt;
 
-    const auto &moves = it->second;
+    // std::cerr << "OpeningBook: найдено ходов = " << it->second.size() << '\n';
+
+    return pickMove(it->second);
+}
 
-    // std::cerr << "OpeningBook: найдено ходов = " << moves.size() << '\n';
+std::optional<Move>
+OpeningBook::pickMove(const std::vector<std::pair<Move, int>> &moves) {
+    if (moves.empty())
+        return std::nullopt;
 
     // Параметр топ-N — размер окна, из которого выбираем ход случайно
     const int topN = 5;
@@ -105,24 +211,13 @@ std::optional<Move> OpeningBook::getOpeningMove(const Board &board,
               [](auto &a, auto &b) { return a.second > b.second; });
 
     // Выбираем случайный ход из топ-N
-    static std::mt19937 rng(std::random_device{}());
+    thread_local std::mt19937 rng(std::random_device{}());
     std::uniform_int_distribution<int> dist(0, limit - 1);
     int idx = dist(rng);
 
     return topMoves[idx].first;
 }
 
-std::string OpeningBook::removeMoveCounters(const std::string &fen) {
-    // Удаляем последние два поля (halfmove clock и fullmove number)
-    size_t lastSpace = fen.rfind(' ');
-    if (lastSpace == std::string::npos)
-        return fen;
-    size_t secondLast = fen.rfind(' ', lastSpace - 1);
-    if (secondLast == std::string::npos)
-        return fen;
-    return fen.substr(0, secondLast);
-}
-
 std::string OpeningBook::trim(const std::string &s) {
     size_t start = s.find_first_not_of(" \t\r\n");
     size_t end = s.find_last_not_of(" \t\r\n");
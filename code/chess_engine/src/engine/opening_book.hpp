@@ -1,31 +1,66 @@
 #pragma once
 
 #include "board/board.hpp"
+#include "board/initialization.hpp"
 #include "engine/move_generator.hpp"
+#include "engine/polyglot_book.hpp"
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace chess::engine {
 
 class OpeningBook {
 public:
-    // Конструктор загружает дебютную базу из файла
+    // Конструктор загружает дебютную базу из файла. Файлы *.bin
+    // открываются как книги Polyglot, остальные читаются как текст
     explicit OpeningBook(const std::string& filename);
 
-    // Получить ход из дебютной книги для позиции (если доступен)
+    // Получить ход из дебютной книги для позиции (если доступен).
+    // Книга не меняется после загрузки, вызов безопасен из любых потоков
     std::optional<Move> getOpeningMove(const Board &board, Color color) const;
 
+    // Общая книга процесса: загружается один раз при первом обращении,
+    // все игроки держат один и тот же экземпляр
+    static std::shared_ptr<const OpeningBook> shared();
+
+    // Путь к общей книге. Если книга уже загружена из другого файла,
+    // следующий вызов shared() загрузит новую
+    static void setSharedPath(const std::string &path);
+    static std::string sharedPath();
+
+    // Начать загрузку общей книги в фоновом потоке. Повторный вызов
+    // после setSharedPath загружает новую книгу
+    static void preloadShared();
+
+    // Ключ позиции в текстовой книге: FEN без счётчиков ходов, поле
+    // взятия на проходе только если взятие возможно
+    static std::string positionKey(const Board &board);
+    // То же в буфере FEN, без выделения памяти
+    static std::string_view positionKey(const Board &board,
+                                        BoardInitializer::FenBuffer &buffer);
+
+    // Переменная окружения CHESS_BOOK_FILE, иначе assets/opening_book.txt
+    // из каталога исходников (ENGINE_ASSETS_DIR), а не из текущего каталога
+    static std::string defaultPath();
+
 private:
     // Дебютная книга: сопоставление FEN → список ходов с частотами
-    std::map<std::string, std::vector<std::pair<Move, int>>> book_;
+    // (std::less<> - поиск по string_view без копии ключа)
+    std::map<std::string, std::vector<std::pair<Move, int>>, std::less<>> book_;
+
+    // Бинарная книга (если файл *.bin)
+    std::unique_ptr<PolyglotBook> binary_;
+
+    // Случайный ход из топ-N по частоте
+    static std::optional<Move>
+    pickMove(const std::vector<std::pair<Move, int>> &moves);
 
     // Конвертация позиции в FEN без счетчиков ходов (для ключа)
     std::string boardToFEN(const Board &board, Color color) const;
 
-    // Удаление счетчиков из FEN (поле 5 и 6)
-    static std::string removeMoveCounters(const std::string& fen);
-
     // Парсинг хода из формата "e2e4" в Move
     static std::optional<Move> parseMove(const std::string& moveStr);
 
@@ -77,7 +77,7 @@ struct PieceSquareTables {
          {-30, -30, 0, 0, 0, 0, -30, -30},
          {-50, -30, -30, -30, -30, -30, -30, -50}}};
 
-    static int get_value(PieceType type, Position pos, Color color, bool endgame) {
+    static constexpr int get_value(PieceType type, Position pos, Color color, bool endgame) {
         int y = (color == Color::WHITE) ? pos.second : 7 - pos.second;
         int x = pos.first;
 
@@ -0,0 +1,140 @@
+#include "engine/polyglot_book.hpp"
+#include "board/zobrist.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+namespace chess::engine {
+namespace {
+
+std::uint64_t read_be(const unsigned char *bytes, int size) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < size; ++i)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+void write_be(std::ostream &out, std::uint64_t value, int size) {
+    for (int i = size - 1; i >= 0; --i)
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+int square_code(Position square) {
+    return square.first + 8 * (7 - square.second);
+}
+
+Position square_of(int code) { return {code % 8, 7 - code / 8}; }
+
+} // namespace
+
+PolyglotBook::PolyglotBook(const std::string &filename)
+    : file_(filename), data_(file_.data()),
+      count_(file_.size() / ENTRY_SIZE) {}
+
+bool PolyglotBook::foreign_keys() const {
+    return !zobrist::POLYGLOT_KEYS &&
+           !find(zobrist::POLYGLOT_START_KEY).empty();
+}
+
+PolyglotBook::Entry PolyglotBook::entry_at(std::size_t index) const {
+    const unsigned char *bytes = data_ + index * ENTRY_SIZE;
+    Entry entry;
+    entry.key = read_be(bytes, 8);
+    entry.move = static_cast<std::uint16_t>(read_be(bytes + 8, 2));
+    entry.weight = static_cast<std::uint16_t>(read_be(bytes + 10, 2));
+    entry.learn = static_cast<std::uint32_t>(read_be(bytes + 12, 4));
+    return entry;
+}
+
+std::vector<PolyglotBook::Entry> PolyglotBook::find(std::uint64_t key) const {
+    // Lower bound over the keys in place
+    std::size_t low = 0;
+    std::size_t high = count_;
+    while (low < high) {
+        const std::size_t mid = low + (high - low) / 2;
+        if (read_be(data_ + mid * ENTRY_SIZE, 8) < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    std::vector<Entry> entries;
+    for (std::size_t i = low;
+         i < count_ && read_be(data_ + i * ENTRY_SIZE, 8) == key; ++i) {
+        entries.push_back(entry_at(i));
+    }
+    return entries;
+}
+
+std::uint16_t PolyglotBook::encode_move(const Board &board, const Move &move) {
+    Position to = move.to;
+    const auto &piece = board.get_piece(move.from);
+    if (piece.get_type() == PieceType::KING &&
+        std::abs(move.to.first - move.from.first) == 2) {
+        to.first = move.to.first > move.from.first ? 7 : 0;
+    }
+    // Same numbering as decode_move: knight 1, bishop 2, rook 3, queen 4
+    int promotion = 0;
+    switch (move.promotion) {
+    case PieceType::KNIGHT: promotion = 1; break;
+    case PieceType::BISHOP: promotion = 2; break;
+    case PieceType::ROOK: promotion = 3; break;
+    case PieceType::QUEEN: promotion = 4; break;
+    default: break;
+    }
+    return static_cast<std::uint16_t>(square_code(to) |
+                                      (square_code(move.from) << 6) |
+                                      (promotion << 12));
+}
+
+Move PolyglotBook::decode_move(const Board &board, std::uint16_t move) {
+    const Position from = square_of((move >> 6) & 63);
+    Position to = square_of(move & 63);
+
+    const auto &piece = board.get_piece(from);
+    const auto &target = board.get_piece(to);
+    if (piece.get_type() == PieceType::KING &&
+        target.get_type() == PieceType::ROOK &&
+        target.get_color() == piece.get_color()) {
+        to.first = to.first > from.first ? 6 : 2;
+    }
+    // Bits 12-14: 0 for no promotion, then knight, bishop, rook, queen
+    static constexpr PieceType promotions[] = {
+        PieceType::NONE, PieceType::KNIGHT, PieceType::BISHOP,
+        PieceType::ROOK, PieceType::QUEEN};
+    const int promotion = (move >> 12) & 7;
+    return {from, to,
+            promotion < 5 ? promotions[promotion] : PieceType::NONE};
+}
+
+std::uint16_t PolyglotBook::scale_weight(long long count, long long max_count) {
+    if (max_count <= 0xFFFF)
+        return static_cast<std::uint16_t>(count);
+    return static_cast<std::uint16_t>(
+        std::max(1LL, count * 0xFFFF / max_count));
+}
+
+void PolyglotBook::write(const std::string &filename,
+                         std::vector<Entry> entries) {
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry &a, const Entry &b) {
+                         if (a.key != b.key)
+                             return a.key < b.key;
+                         return a.weight > b.weight;
+                     });
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot write book: " + filename);
+    for (const auto &entry : entries) {
+        write_be(out, entry.key, 8);
+        write_be(out, entry.move, 2);
+        write_be(out, entry.weight, 2);
+        write_be(out, entry.learn, 4);
+    }
+    if (!out)
+        throw std::runtime_error("Cannot write book: " + filename);
+}
+
+} // namespace chess::engine
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "board/board.hpp"
+#include "engine/mapped_file.hpp"
+#include "engine/move_generator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chess::engine {
+
+// Read-only Polyglot-format book: 16-byte big-endian entries (key, move,
+// weight, learn) sorted by key. The file is memory-mapped and searched in
+// place, so opening it costs one mmap and a lookup is a binary search.
+class PolyglotBook {
+  public:
+    struct Entry {
+        std::uint64_t key = 0;
+        std::uint16_t move = 0;
+        std::uint16_t weight = 0;
+        std::uint32_t learn = 0;
+    };
+    static constexpr std::size_t ENTRY_SIZE = 16;
+
+    // An empty book if the file cannot be opened
+    explicit PolyglotBook(const std::string &filename);
+
+    bool empty() const { return count_ == 0; }
+    std::size_t size() const { return count_; }
+
+    // True if the book was keyed with another Zobrist table than
+    // zobrist::KEYS: it holds Polyglot's initial-position key while our
+    // keys differ, so every probe would miss
+    bool foreign_keys() const;
+
+    // Entries stored for the key, in file order
+    std::vector<Entry> find(std::uint64_t key) const;
+
+    // Polyglot move encoding: to-square in bits 0-5, from-square in bits
+    // 6-11 (file + 8 * row, row 0 = rank 1), promotion in bits 12-14.
+    // Castling is written as the king capturing its own rook.
+    static std::uint16_t encode_move(const Board &board, const Move &move);
+    static Move decode_move(const Board &board, std::uint16_t move);
+
+    // Scales a move count into the 16-bit weight field, keeping the ratios
+    // within a position whose largest count is max_count
+    static std::uint16_t scale_weight(long long count, long long max_count);
+
+    // Sorts by key, heavier moves first, and writes the book.
+    // Throws std::runtime_error if the file cannot be written.
+    static void write(const std::string &filename, std::vector<Entry> entries);
+
+  private:
+    MappedFile file_;
+    const unsigned char *data_ = nullptr;
+    std::size_t count_ = 0;
+
+    Entry entry_at(std::size_t index) const;
+};
+
+} // namespace chess::engine
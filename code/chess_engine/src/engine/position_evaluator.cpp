@@ -1,84 +1,148 @@
 #include "engine/position_evaluator.hpp"
+#include "board/geometry.hpp"
+#include "engine/endgame.hpp"
+#ifdef ENGINE_DEBUG
+#include <iostream>
+#endif
 
 namespace chess::engine {
+namespace {
 
-int PositionEvaluator::evaluate(const Board &board, Color color) {
-    const bool endgame = is_endgame(board);
-    return evaluate_material(board, color) + evaluate_positional(board, color) +
-           evaluate_threats(board, color) +
+using namespace geometry;
+
+bool on_board(int x, int y) { return x >= 0 && x < 8 && y >= 0 && y < 8; }
+
+// 3x3 box around the king plus the three squares two ranks in front of it
+std::uint64_t king_zone(int king_square, int side) {
+    if (king_square < 0)
+        return 0;
+    const int kx = king_square % 8;
+    const int ky = king_square / 8;
+    const int forward = side == 0 ? -1 : 1;
+    std::uint64_t zone = KING_ATTACKS[king_square] | square_bit(king_square);
+    if (on_board(kx, ky + 2 * forward)) {
+        const int front = square_of(kx, ky + 2 * forward);
+        const std::uint64_t front_row = 0xFFULL << (8 * row_of(front));
+        zone |= (KING_ATTACKS[front] | square_bit(front)) & front_row;
+    }
+    return zone;
+}
+
+} // namespace
+
+int PositionEvaluator::evaluate(const Board &board, Color color, int alpha,
+                                int beta) {
+    // Recognised endings: a specialised evaluator replaces everything, a
+    // scale factor applies to the full score so lazy exits are skipped
+    if (const Endgames::Entry *ending = Endgames::probe(board)) {
+        lazy_stats_.endgame_hits++;
+        if (ending->evaluate)
+            return Endgames::score(*ending, board, color);
+        return evaluate_full(board, color) *
+               ending->scale(board, ending->strong) / Endgames::SCALE_NORMAL;
+    }
+
+    // Stage 1: material and PST from the board's incremental counters
+    int score = evaluate_incremental(board, color);
+#ifdef ENGINE_DEBUG
+    const PsqtTotals totals = compute_psqt_totals(board.piece_codes());
+    const int scanned = material_score(totals, color) +
+                        positional_score(board, totals, color);
+    if (score != scanned) {
+        std::cerr << "Incremental eval mismatch: " << score << " vs "
+                  << scanned << "\n";
+    }
+#endif
+    if (outside_window(score, material_margin_, alpha, beta)) {
+        lazy_stats_.material_exits++;
+        return score;
+    }
+
+    // Stage 2: pawn structure
+    score += evaluate_pawn_structure(board, color);
+    if (outside_window(score, pawn_margin_, alpha, beta)) {
+        lazy_stats_.pawn_exits++;
+        return score;
+    }
+
+    // Stage 3: terms built on the attack maps
+    lazy_stats_.full_evaluations++;
+    const AttackInfo info = build_attack_info(board);
+    return score + evaluate_threats(info, color) +
+           evaluate_piece_mobility(info, color) +
+           evaluate_king_safety(board, info, color);
+}
+
+int PositionEvaluator::evaluate_full(const Board &board, Color color) const {
+    const PsqtTotals totals = compute_psqt_totals(board.piece_codes());
+    const AttackInfo info = build_attack_info(board);
+    return material_score(totals, color) +
+           positional_score(board, totals, color) +
+           evaluate_threats(info, color) +
            evaluate_pawn_structure(board, color) +
-           evaluate_piece_mobility(board, color) +
-           evaluate_king_safety(board, color);
+           evaluate_piece_mobility(info, color) +
+           evaluate_king_safety(board, info, color);
 }
 
 bool PositionEvaluator::is_endgame(const Board &board) const {
-    int queen_count = 0;
+    const int queen_count = board.piece_count(Color::WHITE, PieceType::QUEEN) +
+                            board.piece_count(Color::BLACK, PieceType::QUEEN);
     int minor_pieces = 0;
+    for (Color c : {Color::WHITE, Color::BLACK}) {
+        minor_pieces += board.piece_count(c, PieceType::KNIGHT) +
+                        board.piece_count(c, PieceType::BISHOP);
+    }
+    return is_endgame(queen_count, minor_pieces);
+}
+
+int PositionEvaluator::evaluate_incremental(const Board &board,
+                                            Color color) const {
+    const Color enemy = opposite_color(color);
+    int score = 0;
+    for (int type = 1; type <= 6; ++type) {
+        const auto piece_type = static_cast<PieceType>(type);
+        score += PIECE_VALUES[type] * (board.piece_count(color, piece_type) -
+                                       board.piece_count(enemy, piece_type));
+    }
 
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            const auto &piece = board.get_piece({x, y});
-            if (piece.get_type() == PieceType::QUEEN)
-                queen_count++;
-            if (piece.get_type() == PieceType::KNIGHT ||
-                piece.get_type() == PieceType::BISHOP)
-                minor_pieces++;
+    constexpr Position center[] = {{3, 3}, {4, 3}, {3, 4}, {4, 4}};
+    for (auto pos : center) {
+        const auto &piece = board.get_piece(pos);
+        if (piece.get_type() != PieceType::NONE && piece.get_color() == color) {
+            score += CENTER_BONUS;
         }
     }
-    return queen_count == 0 || (queen_count == 1 && minor_pieces <= 2);
+
+    return score + board.psq_score(color, is_endgame(board));
 }
 
 int PositionEvaluator::evaluate_material(const Board &board,
                                          Color color) const {
-    int white_material = 0;
-    int black_material = 0;
-
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            Position pos{x, y};
-            const auto &piece = board.get_piece(pos);
-            if (piece.get_type() == PieceType::NONE)
-                continue;
+    return material_score(compute_psqt_totals(board.piece_codes()), color);
+}
 
-            int value = 0;
-            switch (piece.get_type()) {
-                case PieceType::PAWN:
-                    value = PAWN_VALUE;
-                    break;
-                case PieceType::KNIGHT:
-                    value = KNIGHT_VALUE;
-                    break;
-                case PieceType::BISHOP:
-                    value = BISHOP_VALUE;
-                    break;
-                case PieceType::ROOK:
-                    value = ROOK_VALUE;
-                    break;
-                case PieceType::QUEEN:
-                    value = QUEEN_VALUE;
-                    break;
-                case PieceType::KING:
-                    value = KING_VALUE;
-                    break;
-                default:
-                    break;
-            }
+int PositionEvaluator::evaluate_positional(const Board &board,
+                                           Color color) const {
+    return positional_score(board, compute_psqt_totals(board.piece_codes()),
+                            color);
+}
 
-            if (piece.get_color() == Color::WHITE) {
-                white_material += value;
-            } else {
-                black_material += value;
-            }
-        }
+int PositionEvaluator::material_score(const PsqtTotals &totals,
+                                      Color color) const {
+    const int own = color == Color::WHITE ? 0 : 1;
+    int score = 0;
+    for (int type = 1; type <= 6; ++type) {
+        score += PIECE_VALUES[type] *
+                 (totals.counts[own][type] - totals.counts[1 - own][type]);
     }
-    return (color == Color::WHITE) ? (white_material - black_material)
-                                   : (black_material - white_material);
+    return score;
 }
 
-int PositionEvaluator::evaluate_positional(const Board &board,
-                                           Color color) const {
+int PositionEvaluator::positional_score(const Board &board,
+                                        const PsqtTotals &totals,
+                                        Color color) const {
+    const int own = color == Color::WHITE ? 0 : 1;
     int score = 0;
-    const bool endgame = is_endgame(board);
 
     constexpr Position center[] = {{3, 3}, {4, 3}, {3, 4}, {4, 4}};
     for (auto pos : center) {
@@ -88,23 +152,113 @@ int PositionEvaluator::evaluate_positional(const Board &board,
         }
     }
 
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            Position pos{x, y};
-            const auto &piece = board.get_piece(pos);
-            if (piece.get_type() != PieceType::NONE &&
-                piece.get_color() == color) {
-                score += PieceSquareTables::get_value(piece.get_type(), pos,
-                                                      color, endgame);
+    const auto queen = static_cast<int>(PieceType::QUEEN);
+    const auto knight = static_cast<int>(PieceType::KNIGHT);
+    const auto bishop = static_cast<int>(PieceType::BISHOP);
+    const bool endgame = is_endgame(
+        totals.counts[0][queen] + totals.counts[1][queen],
+        totals.counts[0][knight] + totals.counts[1][knight] +
+            totals.counts[0][bishop] + totals.counts[1][bishop]);
+
+    return score + (endgame ? totals.psq_endgame[own]
+                            : totals.psq_middlegame[own]);
+}
+
+PositionEvaluator::AttackInfo
+PositionEvaluator::build_attack_info(const Board &board) const {
+    const auto &codes = board.piece_codes();
+    AttackInfo info;
+    info.king_square = {-1, -1};
+    for (int square = 0; square < 64; ++square) {
+        if ((codes[square] & 7) == static_cast<int>(PieceType::KING))
+            info.king_square[(codes[square] & Board::BLACK_CODE) ? 1 : 0] =
+                square;
+    }
+    const std::uint64_t zones[2] = {king_zone(info.king_square[0], 0),
+                                    king_zone(info.king_square[1], 1)};
+
+    auto side_of = [&](int square) {
+        const int code = codes[square];
+        if ((code & 7) == 0 || (code & 7) == 7)
+            return -1;
+        return (code & Board::BLACK_CODE) ? 1 : 0;
+    };
+
+    for (int square = 0; square < 64; ++square) {
+        const int side = side_of(square);
+        if (side < 0)
+            continue;
+        const auto type = static_cast<PieceType>(codes[square] & 7);
+        const int x = square % 8;
+        const int y = square / 8;
+        bool hits_zone = false;
+
+        // Marks an attacked square; counts it as a move unless it holds
+        // one of our own pieces
+        auto attack = [&](int target) {
+            info.attacks[side][target]++;
+            if (zones[1 - side] & (1ULL << target))
+                hits_zone = true;
+            if (type != PieceType::PAWN && side_of(target) != side)
+                info.mobility[side]++;
+        };
+
+        switch (type) {
+        case PieceType::PAWN: {
+            const int forward = side == 0 ? -1 : 1;
+            const int start_row = side == 0 ? 6 : 1;
+            std::uint64_t targets = PAWN_ATTACKS[side][square];
+            while (targets) {
+                const int target = pop_square(targets);
+                attack(target);
+                if (side_of(target) == 1 - side)
+                    info.mobility[side]++;
+            }
+            if (on_board(x, y + forward) && side_of((y + forward) * 8 + x) < 0) {
+                info.mobility[side]++;
+                if (y == start_row && side_of((y + 2 * forward) * 8 + x) < 0)
+                    info.mobility[side]++;
             }
+            break;
+        }
+        case PieceType::KNIGHT:
+        case PieceType::KING: {
+            std::uint64_t targets = type == PieceType::KNIGHT
+                                        ? KNIGHT_ATTACKS[square]
+                                        : KING_ATTACKS[square];
+            while (targets)
+                attack(pop_square(targets));
+            break;
+        }
+        default: {
+            const int first = type == PieceType::BISHOP ? 4 : 0;
+            const int last = type == PieceType::ROOK ? 4 : 8;
+            for (int dir = first; dir < last; ++dir) {
+                int target = square;
+                for (int step = RAY_LENGTH[dir][square]; step > 0; --step) {
+                    target += DIRECTION_STEP[dir];
+                    attack(target);
+                    if (side_of(target) >= 0)
+                        break;
+                }
+            }
+            break;
+        }
         }
-    }
 
-    return score;
+        if (hits_zone && KING_ATTACK_UNITS[static_cast<int>(type)] > 0) {
+            info.zone_attackers[side]++;
+            info.zone_units[side] += KING_ATTACK_UNITS[static_cast<int>(type)];
+        }
+    }
+    return info;
 }
 
-int PositionEvaluator::evaluate_threats(const Board &board, Color color) const {
-    return board.is_check(opposite_color(color)) ? CHECK_BONUS : 0;
+int PositionEvaluator::evaluate_threats(const AttackInfo &info,
+                                        Color color) const {
+    const int own = color == Color::WHITE ? 0 : 1;
+    const int enemy_king = info.king_square[1 - own];
+    return enemy_king >= 0 && info.attacks[own][enemy_king] ? CHECK_BONUS : 0;
 }
 
 int PositionEvaluator::evaluate_pawn_structure(const Board &board,
@@ -152,45 +306,63 @@ int PositionEvaluator::evaluate_pawn_structure(const Board &board,
                 score -= ISOLATED_PAWN_PENALTY;
         }
     }
-    return score;
+    return std::clamp(score, -PAWN_STAGE_LIMIT, PAWN_STAGE_LIMIT);
 }
 
-int PositionEvaluator::evaluate_piece_mobility(const Board &board,
+int PositionEvaluator::evaluate_piece_mobility(const AttackInfo &info,
                                                Color color) const {
-    int mobility = 0;
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            Position pos{x, y};
-            const auto &piece = board.get_piece(pos);
-            if (piece.get_color() != color)
-                continue;
-
-            auto moves = board.get_legal_moves(pos);
-            mobility += moves.size() * MOBILITY_BONUS;
-        }
-    }
-    return mobility;
+    return std::min(info.mobility[color == Color::WHITE ? 0 : 1],
+                    MOBILITY_LIMIT) *
+           MOBILITY_BONUS;
 }
 
 int PositionEvaluator::evaluate_king_safety(const Board &board,
+                                            const AttackInfo &info,
                                             Color color) const {
+    const int own = color == Color::WHITE ? 0 : 1;
+    return king_safety(board, info, own) - king_safety(board, info, 1 - own);
+}
+
+// Shield bonus minus danger for the king of `own` (0 white, 1 black)
+int PositionEvaluator::king_safety(const Board &board, const AttackInfo &info,
+                                   int own) const {
+    if (info.king_square[own] < 0)
+        return 0;
+    const int kx = info.king_square[own] % 8;
+    const auto &codes = board.piece_codes();
+    const auto own_pawn = static_cast<std::uint8_t>(
+        static_cast<int>(PieceType::PAWN) | (own ? Board::BLACK_CODE : 0));
+    const auto enemy_pawn = static_cast<std::uint8_t>(
+        static_cast<int>(PieceType::PAWN) | (own ? 0 : Board::BLACK_CODE));
+
     int safety = 0;
-    Position king_pos = board.find_king(color);
-
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            int x = king_pos.first + dx;
-            int y = king_pos.second + dy;
-            if (x >= 0 && x < 8 && y >= 0 && y < 8) {
-                const auto &piece = board.get_piece({x, y});
-                if (piece.get_type() == PieceType::PAWN &&
-                    piece.get_color() == color) {
-                    safety += KING_SHIELD_BONUS;
-                }
+    std::uint64_t shield = KING_ATTACKS[info.king_square[own]];
+    while (shield) {
+        if (codes[pop_square(shield)] == own_pawn)
+            safety += KING_SHIELD_BONUS;
+    }
+
+    // A single attacker is not an attack; file weaknesses count regardless
+    int units = info.zone_attackers[1 - own] >= 2 ? info.zone_units[1 - own] : 0;
+    const Color enemy = own ? Color::WHITE : Color::BLACK;
+    const bool enemy_has_heavies = board.piece_count(enemy, PieceType::ROOK) +
+                                       board.piece_count(enemy, PieceType::QUEEN) >
+                                   0;
+    if (enemy_has_heavies) {
+        for (int file = std::max(0, kx - 1); file <= std::min(7, kx + 1);
+             ++file) {
+            bool own_pawns = false;
+            bool enemy_pawns = false;
+            for (int rank = 0; rank < 8; ++rank) {
+                own_pawns |= codes[rank * 8 + file] == own_pawn;
+                enemy_pawns |= codes[rank * 8 + file] == enemy_pawn;
             }
+            if (!own_pawns)
+                units += enemy_pawns ? HALF_OPEN_FILE_UNITS : OPEN_FILE_UNITS;
         }
     }
-    return safety;
+
+    return safety - KING_DANGER[std::min(units, KING_DANGER_SIZE - 1)];
 }
 
 int PositionEvaluator::doubled_pawns_penalty(const Board &board,
@@ -1,21 +1,17 @@
 #pragma once
 #include "board/board.hpp"
+#include "engine/evaluator.hpp"
+#include "engine/psqt_kernel.hpp"
 #include "piece_square_tables.hpp"
 #include <algorithm>
+#include <array>
+#include <cstdint>
 
 namespace chess::engine {
 
-class PositionEvaluator {
+class PositionEvaluator : public Evaluator {
 public:
-    virtual ~PositionEvaluator() = default;
-    
-    static Color opposite_color(Color c) {
-        return c == Color::WHITE ? Color::BLACK : Color::WHITE;
-    }
-    
-    int evaluate(const Board& board, Color color);
-
-protected:
+    // Centipawn piece values, also the scale of the endgame evaluators
     static constexpr int PAWN_VALUE = 100;
     static constexpr int KNIGHT_VALUE = 320;
     static constexpr int BISHOP_VALUE = 330;
@@ -23,6 +19,39 @@ protected:
     static constexpr int QUEEN_VALUE = 900;
     static constexpr int KING_VALUE = 20000;
 
+    // Lazy evaluation counters: how often each stage was the last one run
+    struct LazyStats {
+        std::uint64_t material_exits = 0; // after material + PST
+        std::uint64_t pawn_exits = 0;     // after pawn structure
+        std::uint64_t full_evaluations = 0;
+        std::uint64_t endgame_hits = 0; // material key found in Endgames
+    };
+
+    // Staged evaluation: cheap incremental terms first, the expensive ones
+    // only when the partial score is within the margin of [alpha, beta].
+    int evaluate(const Board& board, Color color, int alpha = MIN_SCORE,
+                 int beta = MAX_SCORE) override;
+    std::unique_ptr<Evaluator> clone() const override {
+        return std::make_unique<PositionEvaluator>(*this);
+    }
+
+    // Every term from a full board scan, without lazy exits, incremental
+    // counters or endgame knowledge. Used for verification.
+    int evaluate_full(const Board& board, Color color) const;
+
+    const LazyStats& lazy_stats() const { return lazy_stats_; }
+    void reset_lazy_stats() { lazy_stats_ = {}; }
+    void set_lazy_margins(int material_margin, int pawn_margin) {
+        material_margin_ = material_margin;
+        pawn_margin_ = pawn_margin;
+    }
+
+protected:
+    // Indexed by PieceType
+    static constexpr std::array<int, 8> PIECE_VALUES = {
+        0, PAWN_VALUE, KNIGHT_VALUE, BISHOP_VALUE, ROOK_VALUE, QUEEN_VALUE,
+        KING_VALUE, 0};
+
     static constexpr int CENTER_BONUS = 10;
     static constexpr int DOUBLED_PAWN_PENALTY = 20;
     static constexpr int ISOLATED_PAWN_PENALTY = 30;
@@ -31,16 +60,88 @@ protected:
     static constexpr int KING_SHIELD_BONUS = 20;
     static constexpr int CHECK_BONUS = 40;
 
+    // King danger: attack units of pieces hitting the king zone, indexed by
+    // PieceType, plus units for open (no pawns) and half-open (enemy pawns
+    // only) files next to the king
+    static constexpr std::array<int, 8> KING_ATTACK_UNITS = {0, 0, 2, 2,
+                                                             3, 5, 0, 0};
+    static constexpr int OPEN_FILE_UNITS = 2;
+    static constexpr int HALF_OPEN_FILE_UNITS = 1;
+    static constexpr int KING_DANGER_LIMIT = 250;
+    static constexpr int KING_DANGER_SIZE = 64;
+
+    // Quadratic in attack units, saturating at KING_DANGER_LIMIT
+    static constexpr std::array<int, KING_DANGER_SIZE> KING_DANGER = [] {
+        std::array<int, KING_DANGER_SIZE> table{};
+        for (int units = 0; units < KING_DANGER_SIZE; ++units) {
+            table[units] = std::min(KING_DANGER_LIMIT, units * units * 3 / 2);
+        }
+        return table;
+    }();
+
+    // Attack maps of both sides from one pass over the board, shared by
+    // threats, mobility and king safety. Indices are [colour][square] with
+    // square = y * 8 + x, as in Board::piece_codes().
+    struct AttackInfo {
+        std::array<std::array<std::uint8_t, 64>, 2> attacks{};
+        std::array<int, 2> mobility{};       // pseudo-legal moves
+        std::array<int, 2> king_square{};    // -1 if there is no king
+        std::array<int, 2> zone_attackers{}; // pieces hitting the enemy zone
+        std::array<int, 2> zone_units{};
+    };
+
+    // Stage 3 (threats, mobility, king safety) moves the score by at most
+    // ATTACK_STAGE_LIMIT either way: the check bonus, capped mobility, and
+    // a full shield of our own against the enemy king in full danger.
+    // The pawn stage may only exit lazily beyond that.
+    static constexpr int MOBILITY_LIMIT = 128;
+    static constexpr int KING_SHIELD_LIMIT = 8 * KING_SHIELD_BONUS;
+    static constexpr int ATTACK_STAGE_LIMIT =
+        CHECK_BONUS + MOBILITY_LIMIT * MOBILITY_BONUS + KING_SHIELD_LIMIT +
+        KING_DANGER_LIMIT;
+
+    // Stage 2, pawn structure, is clamped to PAWN_STAGE_LIMIT either way,
+    // so the material stage may exit beyond both bounds together
+    static constexpr int PAWN_STAGE_LIMIT = 400;
+
+    static constexpr int LAZY_MATERIAL_MARGIN = 1000;
+    static constexpr int LAZY_PAWN_MARGIN = 600;
+    static_assert(LAZY_MATERIAL_MARGIN > PAWN_STAGE_LIMIT + ATTACK_STAGE_LIMIT,
+                  "the material-stage lazy exit must cover stages 2 and 3");
+    static_assert(LAZY_PAWN_MARGIN > ATTACK_STAGE_LIMIT,
+                  "the pawn-stage lazy exit must cover every stage 3 term");
+
     // Основные методы оценки
     bool is_endgame(const Board& board) const;
+    static bool is_endgame(int queen_count, int minor_pieces) {
+        return queen_count == 0 || (queen_count == 1 && minor_pieces <= 2);
+    }
+    int evaluate_incremental(const Board& board, Color color) const;
     int evaluate_material(const Board& board, Color color) const;
     int evaluate_positional(const Board& board, Color color) const;
-    int evaluate_threats(const Board& board, Color color) const;
+    AttackInfo build_attack_info(const Board& board) const;
+    int evaluate_threats(const AttackInfo& info, Color color) const;
     int evaluate_pawn_structure(const Board& board, Color color) const;
-    int evaluate_piece_mobility(const Board& board, Color color) const;
-    int evaluate_king_safety(const Board& board, Color color) const;
+    int evaluate_piece_mobility(const AttackInfo& info, Color color) const;
+    int evaluate_king_safety(const Board& board, const AttackInfo& info,
+                             Color color) const;
+    int king_safety(const Board& board, const AttackInfo& info,
+                    int side) const;
     int doubled_pawns_penalty(const Board& board, Color color) const;
     int count_pawns_on_file(const Board& board, int file, Color color) const;
+
+private:
+    int material_score(const PsqtTotals& totals, Color color) const;
+    int positional_score(const Board& board, const PsqtTotals& totals,
+                         Color color) const;
+
+    int material_margin_ = LAZY_MATERIAL_MARGIN;
+    int pawn_margin_ = LAZY_PAWN_MARGIN;
+    LazyStats lazy_stats_;
+
+    static bool outside_window(int score, int margin, int alpha, int beta) {
+        return score + margin <= alpha || score - margin >= beta;
+    }
 };
 
 } // namespace chess::engine
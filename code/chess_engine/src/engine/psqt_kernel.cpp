@@ -0,0 +1,126 @@
+#include "engine/psqt_kernel.hpp"
+#include "engine/piece_square_tables.hpp"
+#include "engine/simd.hpp"
+
+namespace chess::engine {
+namespace {
+
+// One int32 per (piece code, square): middlegame value in the low half,
+// endgame value in the high half. Both halves are summed lane-wise as int16.
+struct PackedPsqt {
+    std::int32_t values[16][64] = {};
+};
+
+constexpr PackedPsqt build_packed_psqt() {
+    PackedPsqt table;
+    for (int code = 0; code < 16; ++code) {
+        const auto type = static_cast<PieceType>(code & 7);
+        if (type == PieceType::NONE || type == PieceType::HIGHLIGHT)
+            continue;
+        const Color color = (code & Board::BLACK_CODE) ? Color::BLACK : Color::WHITE;
+
+        for (int square = 0; square < 64; ++square) {
+            Position pos{square % 8, square / 8};
+            int mg = PieceSquareTables::get_value(type, pos, color, false);
+            int eg = PieceSquareTables::get_value(type, pos, color, true);
+            table.values[code][square] = static_cast<std::int32_t>(
+                static_cast<std::uint16_t>(mg) |
+                (static_cast<std::uint32_t>(static_cast<std::uint16_t>(eg))
+                 << 16));
+        }
+    }
+    return table;
+}
+
+constexpr PackedPsqt PACKED_PSQT = build_packed_psqt();
+
+PsqtTotals compute_scalar(const std::uint8_t *codes) {
+    PsqtTotals totals;
+    for (int square = 0; square < 64; ++square) {
+        const int code = codes[square];
+        if ((code & 7) == 0 || (code & 7) == 7)
+            continue;
+        const int side = (code & Board::BLACK_CODE) ? 1 : 0;
+        const std::int32_t packed = PACKED_PSQT.values[code][square];
+        totals.counts[side][code & 7]++;
+        totals.psq_middlegame[side] += static_cast<std::int16_t>(packed & 0xFFFF);
+        totals.psq_endgame[side] += static_cast<std::int16_t>(packed >> 16);
+    }
+    return totals;
+}
+
+#ifdef ENGINE_X86_SIMD
+ENGINE_TARGET("avx2")
+int horizontal_sum(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v),
+                                _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+ENGINE_TARGET("avx2")
+PsqtTotals compute_avx2(const std::uint8_t *codes) {
+    PsqtTotals totals;
+
+    // Counts: compare all 64 bytes against each piece code
+    const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codes));
+    const __m256i high =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codes + 32));
+    for (int side = 0; side < 2; ++side) {
+        for (int type = 1; type <= 6; ++type) {
+            const __m256i code = _mm256_set1_epi8(
+                static_cast<char>(type | (side ? Board::BLACK_CODE : 0)));
+            unsigned low_mask = static_cast<unsigned>(
+                _mm256_movemask_epi8(_mm256_cmpeq_epi8(low, code)));
+            unsigned high_mask = static_cast<unsigned>(
+                _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, code)));
+            totals.counts[side][type] =
+                __builtin_popcount(low_mask) + __builtin_popcount(high_mask);
+        }
+    }
+
+    // Piece-square values: gather eight squares at a time
+    const __m256i lane_squares = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i black_bit = _mm256_set1_epi32(Board::BLACK_CODE);
+    __m256i white_sum = _mm256_setzero_si256();
+    __m256i black_sum = _mm256_setzero_si256();
+    for (int square = 0; square < 64; square += 8) {
+        const __m256i code = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(codes + square)));
+        const __m256i index = _mm256_add_epi32(
+            _mm256_slli_epi32(code, 6),
+            _mm256_add_epi32(_mm256_set1_epi32(square), lane_squares));
+        const __m256i packed = _mm256_i32gather_epi32(
+            &PACKED_PSQT.values[0][0], index, sizeof(std::int32_t));
+        const __m256i is_black =
+            _mm256_cmpeq_epi32(_mm256_and_si256(code, black_bit), black_bit);
+        black_sum = _mm256_add_epi16(black_sum, _mm256_and_si256(is_black, packed));
+        white_sum =
+            _mm256_add_epi16(white_sum, _mm256_andnot_si256(is_black, packed));
+    }
+
+    const __m256i sums[2] = {white_sum, black_sum};
+    for (int side = 0; side < 2; ++side) {
+        const __m256i middlegame =
+            _mm256_srai_epi32(_mm256_slli_epi32(sums[side], 16), 16);
+        const __m256i endgame = _mm256_srai_epi32(sums[side], 16);
+        totals.psq_middlegame[side] = horizontal_sum(middlegame);
+        totals.psq_endgame[side] = horizontal_sum(endgame);
+    }
+    return totals;
+}
+#endif
+
+} // namespace
+
+PsqtTotals compute_psqt_totals(const std::array<std::uint8_t, 64> &codes) {
+#ifdef ENGINE_X86_SIMD
+    if (simd::level() == simd::Level::AVX2) {
+        return compute_avx2(codes.data());
+    }
+#endif
+    return compute_scalar(codes.data());
+}
+
+} // namespace chess::engine
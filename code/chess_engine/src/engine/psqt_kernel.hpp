@@ -0,0 +1,19 @@
+#pragma once
+#include "board/board.hpp"
+#include <array>
+#include <cstdint>
+
+namespace chess::engine {
+
+// Piece counts and piece-square sums of a whole board, computed from
+// Board::piece_codes() rather than the board's incremental counters.
+struct PsqtTotals {
+    std::array<std::array<int, 8>, 2> counts{}; // [colour][PieceType]
+    std::array<int, 2> psq_middlegame{};
+    std::array<int, 2> psq_endgame{};
+};
+
+// AVX2 gather kernel when the CPU has it, scalar loop otherwise
+PsqtTotals compute_psqt_totals(const std::array<std::uint8_t, 64> &codes);
+
+} // namespace chess::engine
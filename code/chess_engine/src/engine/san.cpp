@@ -0,0 +1,101 @@
+#include "engine/san.hpp"
+#include <algorithm>
+
+namespace chess::engine {
+namespace {
+
+PieceType piece_from_letter(char letter) {
+    switch (letter) {
+    case 'N': return PieceType::KNIGHT;
+    case 'B': return PieceType::BISHOP;
+    case 'R': return PieceType::ROOK;
+    case 'Q': return PieceType::QUEEN;
+    case 'K': return PieceType::KING;
+    default: return PieceType::NONE;
+    }
+}
+
+bool is_file(char c) { return c >= 'a' && c <= 'h'; }
+bool is_rank(char c) { return c >= '1' && c <= '8'; }
+
+} // namespace
+
+std::optional<SanMove> parse_san(const Board &board, std::string_view san) {
+    while (!san.empty() && std::string_view("+#!?").find(san.back()) !=
+                               std::string_view::npos) {
+        san.remove_suffix(1);
+    }
+    if (san.empty())
+        return std::nullopt;
+
+    const Color side = board.current_player;
+    PieceType type = PieceType::PAWN;
+    PieceType promotion = PieceType::NONE;
+    int from_file = -1;
+    int from_row = -1;
+    Position to;
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        // Castling is a two-square king move on the board
+        const Position king = board.find_king(side);
+        type = PieceType::KING;
+        to = {king.first + (san.size() == 3 ? 2 : -2), king.second};
+    } else {
+        if (piece_from_letter(san.front()) != PieceType::NONE) {
+            type = piece_from_letter(san.front());
+            san.remove_prefix(1);
+        }
+
+        // Promotion: "e8=Q" or "e8Q"
+        if (type == PieceType::PAWN && san.size() >= 3 &&
+            piece_from_letter(san.back()) != PieceType::NONE) {
+            promotion = piece_from_letter(san.back());
+            san.remove_suffix(1);
+            if (san.back() == '=')
+                san.remove_suffix(1);
+        }
+
+        if (san.size() < 2 || !is_file(san[san.size() - 2]) ||
+            !is_rank(san.back()))
+            return std::nullopt;
+        to = {san[san.size() - 2] - 'a', '8' - san.back()};
+        san.remove_suffix(2);
+
+        // What is left is disambiguation and the capture mark
+        for (char c : san) {
+            if (is_file(c))
+                from_file = c - 'a';
+            else if (is_rank(c))
+                from_row = '8' - c;
+            else if (c != 'x' && c != ':' && c != '-')
+                return std::nullopt;
+        }
+        // A pawn push stays on its file
+        if (type == PieceType::PAWN && from_file < 0)
+            from_file = to.first;
+    }
+
+    std::optional<SanMove> found;
+    for (int y = 0; y < 8; ++y) {
+        if (from_row >= 0 && y != from_row)
+            continue;
+        for (int x = 0; x < 8; ++x) {
+            if (from_file >= 0 && x != from_file)
+                continue;
+            const auto &piece = board.get_piece({x, y});
+            if (piece.get_type() != type || piece.get_color() != side)
+                continue;
+
+            const auto targets = board.get_legal_moves({x, y});
+            if (std::find(targets.begin(), targets.end(), to) ==
+                targets.end())
+                continue;
+            if (found)
+                return std::nullopt; // ambiguous
+            found = SanMove{{{x, y}, to}, promotion};
+        }
+    }
+    return found;
+}
+
+} // namespace chess::engine
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "board/board.hpp"
+#include "engine/move_generator.hpp"
+#include <optional>
+#include <string_view>
+
+namespace chess::engine {
+
+struct SanMove {
+    Move move;
+    PieceType promotion = PieceType::NONE;
+};
+
+// Resolves a SAN token ("Nbd7", "exd6", "O-O", "e8=Q+") against the legal
+// moves of the side to move. Check marks and annotations are ignored;
+// unknown, illegal or ambiguous tokens give nullopt.
+std::optional<SanMove> parse_san(const Board &board, std::string_view san);
+
+} // namespace chess::engine
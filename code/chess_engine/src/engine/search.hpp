@@ -0,0 +1,82 @@
+#pragma once
+#include "board/move.hpp"
+#include "engine/search_stats.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace chess::engine {
+
+using Position = chess::Position;
+using Move = chess::Move;
+
+// Mates score MATE_SCORE minus the plies from the root to the mate, so a
+// shorter mate is better; being mated is the negation. Every score beyond
+// MATE_BOUND is a mate.
+constexpr int MATE_SCORE = 100000;
+constexpr int MATE_BOUND = MATE_SCORE - 1000;
+
+inline bool is_mate_score(int score) {
+    return score >= MATE_BOUND || score <= -MATE_BOUND;
+}
+
+// Moves to mate as UCI "score mate" counts them: positive when the side to
+// move mates, negative when it is mated
+inline int mate_in_moves(int score) {
+    return score > 0 ? (MATE_SCORE - score + 1) / 2 : -(MATE_SCORE + score) / 2;
+}
+
+// Limits of one search; zero means "no limit". Clock values are in
+// milliseconds and indexed by colour, white first.
+struct SearchLimits {
+    int depth = 0;
+    std::uint64_t nodes = 0; // all search threads together
+    int movetime = 0;
+    int mate = 0; // mate in N moves: searched to 2N - 1 plies
+    bool infinite = false;
+    int time[2] = {0, 0};
+    int increment[2] = {0, 0};
+    int movestogo = 0;
+    int move_overhead = 0; // kept back from every time budget for I/O lag
+    int multipv = 1;       // number of best root moves with exact scores
+};
+
+// Set by another thread while a search runs. ponder keeps the search going
+// with no time limit until it is cleared (ponderhit) or stop is set.
+struct SearchSignals {
+    std::atomic<bool> stop{false};
+    std::atomic<bool> ponder{false};
+};
+
+struct PvLine {
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+struct SearchResult {
+    Move best{};
+    std::vector<Move> pv;
+    int score = 0;
+    int depth = 0;
+    std::vector<PvLine> lines; // MultiPV lines, best first
+    SearchStats stats;         // all threads together
+};
+
+// Progress report. An empty pv means a periodic update between iterations
+// with nodes, time and hashfull only.
+struct SearchInfo {
+    int depth = 0;
+    int seldepth = 0;
+    int score = 0; // side to move's point of view
+    std::uint64_t nodes = 0;
+    long long time_ms = 0;
+    int hashfull = 0;
+    std::vector<Move> pv;
+    int multipv = 1; // line number, 1 is the best
+};
+
+using InfoCallback = std::function<void(const SearchInfo &)>;
+
+} // namespace chess::engine
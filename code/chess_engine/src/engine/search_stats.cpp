@@ -0,0 +1,44 @@
+#include "engine/search_stats.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace chess::engine {
+
+void SearchStats::merge(const SearchStats &other) {
+    nodes += other.nodes;
+    seldepth = std::max(seldepth, other.seldepth);
+    tt_probes += other.tt_probes;
+    tt_hits += other.tt_hits;
+    tt_cutoffs += other.tt_cutoffs;
+    cutoffs += other.cutoffs;
+    first_move_cutoffs += other.first_move_cutoffs;
+}
+
+std::string SearchStats::summary() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "nodes " << nodes
+        << " seldepth " << seldepth;
+    if (enabled) {
+        out << " tt_probes " << tt_probes << " tt_hit_rate " << tt_hit_rate()
+            << " tt_cutoffs " << tt_cutoffs << " cutoffs " << cutoffs
+            << " first_move_cutoff_rate " << first_move_cutoff_rate();
+    }
+    return out.str();
+}
+
+std::string SearchStats::to_json() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4) << "{\"nodes\": " << nodes
+        << ", \"seldepth\": " << seldepth
+        << ", \"stats_enabled\": " << (enabled ? "true" : "false")
+        << ", \"tt\": {\"probes\": " << tt_probes << ", \"hits\": " << tt_hits
+        << ", \"cutoffs\": " << tt_cutoffs
+        << ", \"hit_rate\": " << tt_hit_rate() << "}"
+        << ", \"cutoffs\": {\"total\": " << cutoffs
+        << ", \"first_move\": " << first_move_cutoffs
+        << ", \"first_move_rate\": " << first_move_cutoff_rate() << "}}";
+    return out.str();
+}
+
+} // namespace chess::engine
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace chess::engine {
+
+// Per-thread search counters. Nodes and seldepth are always tracked; the
+// rest is only collected in ENGINE_STATS builds, through ENGINE_STAT(),
+// which compiles to nothing otherwise.
+struct SearchStats {
+#ifdef ENGINE_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    std::uint64_t nodes = 0;
+    int seldepth = 0;
+
+    std::uint64_t tt_probes = 0;
+    std::uint64_t tt_hits = 0;
+    std::uint64_t tt_cutoffs = 0;
+
+    std::uint64_t cutoffs = 0;            // beta cutoffs
+    std::uint64_t first_move_cutoffs = 0; // ... by the first move searched
+
+    void record_cutoff(bool first_move) {
+        ++cutoffs;
+        if (first_move)
+            ++first_move_cutoffs;
+    }
+
+    // Sums counters of several threads; seldepth is the maximum
+    void merge(const SearchStats &other);
+
+    // Ratios in [0, 1]; 0 when nothing was counted
+    double tt_hit_rate() const { return ratio(tt_hits, tt_probes); }
+    double first_move_cutoff_rate() const {
+        return ratio(first_move_cutoffs, cutoffs);
+    }
+
+    // One line of "key value" pairs, for UCI "info string" and the CLI
+    std::string summary() const;
+    std::string to_json() const;
+
+  private:
+    static double ratio(std::uint64_t part, std::uint64_t total) {
+        return total == 0 ? 0.0 : static_cast<double>(part) / total;
+    }
+};
+
+} // namespace chess::engine
+
+#ifdef ENGINE_STATS
+#define ENGINE_STAT(statement) statement
+#else
+#define ENGINE_STAT(statement) ((void)0)
+#endif
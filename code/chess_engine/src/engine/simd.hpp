@@ -0,0 +1,50 @@
+#pragma once
+
+// Runtime selection of vector kernels. Kernels are compiled per instruction
+// set with the target attribute, so the binary itself stays portable and the
+// best variant is picked on the running CPU.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ENGINE_X86_SIMD 1
+#define ENGINE_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#endif
+
+namespace chess::engine::simd {
+
+enum class Level { SCALAR, SSE41, AVX2 };
+
+inline Level detected_level() {
+#ifdef ENGINE_X86_SIMD
+    static const Level level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return Level::AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return Level::SSE41;
+        return Level::SCALAR;
+    }();
+    return level;
+#else
+    return Level::SCALAR;
+#endif
+}
+
+namespace detail {
+inline Level &forced_level() {
+    static Level level = detected_level();
+    return level;
+}
+} // namespace detail
+
+// Level used by the kernels; never above what the CPU supports
+inline Level level() { return detail::forced_level(); }
+
+// Lower the kernel level, e.g. to compare vector and scalar results
+inline void set_level(Level requested) {
+    detail::forced_level() =
+        static_cast<int>(requested) < static_cast<int>(detected_level())
+            ? requested
+            : detected_level();
+}
+
+} // namespace chess::engine::simd
@@ -0,0 +1,92 @@
+#include "engine/transposition_table.hpp"
+#include <algorithm>
+
+namespace chess::engine {
+namespace {
+
+// Data word: score in the low 32 bits, then depth (8), bound (2),
+// generation (6) and move (12)
+constexpr int DEPTH_SHIFT = 32;
+constexpr int BOUND_SHIFT = 40;
+constexpr int GENERATION_SHIFT = 42;
+constexpr int MOVE_SHIFT = 48;
+
+std::uint64_t pack(int score, int depth, TranspositionTable::Bound bound,
+                   std::uint64_t generation, std::uint16_t move) {
+    return static_cast<std::uint32_t>(score) |
+           (static_cast<std::uint64_t>(std::clamp(depth, 0, 255))
+            << DEPTH_SHIFT) |
+           (static_cast<std::uint64_t>(bound) << BOUND_SHIFT) |
+           (generation << GENERATION_SHIFT) |
+           (static_cast<std::uint64_t>(move & 0xFFF) << MOVE_SHIFT);
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(std::size_t size_mb) {
+    resize(size_mb);
+}
+
+void TranspositionTable::resize(std::size_t size_mb) {
+    size_mb_ = std::max<std::size_t>(size_mb, 1);
+    count_ = size_mb_ * 1024 * 1024 / sizeof(Slot);
+    slots_ = std::make_unique<Slot[]>(count_);
+    generation_ = 0;
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < count_; ++i) {
+        slots_[i].key.store(0, std::memory_order_relaxed);
+        slots_[i].data.store(0, std::memory_order_relaxed);
+    }
+    generation_ = 0;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, Entry &entry) const {
+    const Slot &s = slot(key);
+    const std::uint64_t data = s.data.load(std::memory_order_relaxed);
+    if (data == 0 || (s.key.load(std::memory_order_relaxed) ^ data) != key)
+        return false;
+
+    entry.score = static_cast<std::int32_t>(data & 0xFFFFFFFF);
+    entry.depth = static_cast<int>((data >> DEPTH_SHIFT) & 0xFF);
+    entry.bound = static_cast<Bound>((data >> BOUND_SHIFT) & 0x3);
+    entry.move = static_cast<std::uint16_t>((data >> MOVE_SHIFT) & 0xFFF);
+    return true;
+}
+
+void TranspositionTable::store(std::uint64_t key, int depth, int score,
+                               Bound bound, std::uint16_t move) {
+    Slot &s = slot(key);
+    const std::uint64_t old = s.data.load(std::memory_order_relaxed);
+    const bool same_key = (s.key.load(std::memory_order_relaxed) ^ old) == key;
+
+    // A deeper result for the same position from this search survives
+    // anything but an exact score
+    if (same_key && old != 0 && bound != Bound::EXACT &&
+        ((old >> GENERATION_SHIFT) & GENERATION_MASK) == generation_ &&
+        static_cast<int>((old >> DEPTH_SHIFT) & 0xFF) > depth)
+        return;
+
+    // Keep the old best move when the new result has none
+    if (same_key && move == 0)
+        move = static_cast<std::uint16_t>((old >> MOVE_SHIFT) & 0xFFF);
+
+    const std::uint64_t data = pack(score, depth, bound, generation_, move);
+    s.key.store(key ^ data, std::memory_order_relaxed);
+    s.data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    const std::size_t sample = std::min<std::size_t>(1000, count_);
+    int used = 0;
+    for (std::size_t i = 0; i < sample; ++i) {
+        const std::uint64_t data = slots_[i].data.load(std::memory_order_relaxed);
+        if (data != 0 &&
+            ((data >> GENERATION_SHIFT) & GENERATION_MASK) == generation_)
+            ++used;
+    }
+    return static_cast<int>(used * 1000 / sample);
+}
+
+} // namespace chess::engine
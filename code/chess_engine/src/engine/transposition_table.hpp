@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace chess::engine {
+
+// Shared hash table of search results. Every entry is two 64-bit words, the
+// key stored xor-ed with the data, so a torn write by a concurrent search
+// just fails the key check instead of returning a mixed entry.
+class TranspositionTable {
+  public:
+    enum class Bound : std::uint8_t { NONE = 0, UPPER = 1, LOWER = 2, EXACT = 3 };
+
+    struct Entry {
+        int score = 0; // side to move's point of view
+        int depth = 0;
+        Bound bound = Bound::NONE;
+        std::uint16_t move = 0; // from * 64 + to, 0 if none
+    };
+
+    static constexpr std::size_t DEFAULT_SIZE_MB = 16;
+
+    explicit TranspositionTable(std::size_t size_mb = DEFAULT_SIZE_MB);
+
+    void resize(std::size_t size_mb);
+    void clear();
+    std::size_t size_mb() const { return size_mb_; }
+
+    // Called once per search: entries of older searches get replaced first
+    void new_search() { generation_ = (generation_ + 1) & GENERATION_MASK; }
+
+    bool probe(std::uint64_t key, Entry &entry) const;
+    void store(std::uint64_t key, int depth, int score, Bound bound,
+               std::uint16_t move);
+
+    // Permille of entries written by the current search, from a sample
+    int hashfull() const;
+
+  private:
+    struct Slot {
+        std::atomic<std::uint64_t> key{0}; // key ^ data
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    static constexpr std::uint64_t GENERATION_MASK = 0x3F;
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t count_ = 0;
+    std::size_t size_mb_ = 0;
+    std::uint64_t generation_ = 0;
+
+    Slot &slot(std::uint64_t key) const { return slots_[key % count_]; }
+};
+
+} // namespace chess::engine
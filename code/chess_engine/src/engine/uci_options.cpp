@@ -0,0 +1,149 @@
+#include "engine/uci_options.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace chess::engine {
+namespace {
+
+bool same_name(const std::string &a, const std::string &b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+std::string trim(const std::string &text) {
+    const auto first = text.find_first_not_of(' ');
+    if (first == std::string::npos)
+        return {};
+    return text.substr(first, text.find_last_not_of(' ') - first + 1);
+}
+
+const char *type_name(UciOptions::Type type) {
+    switch (type) {
+    case UciOptions::Type::SPIN:
+        return "spin";
+    case UciOptions::Type::CHECK:
+        return "check";
+    case UciOptions::Type::BUTTON:
+        return "button";
+    default:
+        return "string";
+    }
+}
+
+} // namespace
+
+UciOptions::Option &UciOptions::add(Option option) {
+    option.value = option.default_value;
+    options_.push_back(std::move(option));
+    return options_.back();
+}
+
+void UciOptions::add_spin(const std::string &name, int default_value, int min,
+                          int max, Callback on_change) {
+    add({name, Type::SPIN, std::to_string(default_value), min, max, {},
+         std::move(on_change)});
+}
+
+void UciOptions::add_check(const std::string &name, bool default_value,
+                           Callback on_change) {
+    add({name, Type::CHECK, default_value ? "true" : "false", 0, 0, {},
+         std::move(on_change)});
+}
+
+void UciOptions::add_string(const std::string &name,
+                            const std::string &default_value,
+                            Callback on_change) {
+    add({name, Type::STRING, default_value, 0, 0, {}, std::move(on_change)});
+}
+
+void UciOptions::add_button(const std::string &name, Callback on_press) {
+    add({name, Type::BUTTON, {}, 0, 0, {}, std::move(on_press)});
+}
+
+void UciOptions::print(std::ostream &out) const {
+    for (const auto &option : options_) {
+        out << "option name " << option.name << " type "
+            << type_name(option.type);
+        if (option.type == Type::BUTTON) {
+            out << "\n";
+            continue;
+        }
+        // UCI spells an empty string default as <empty>
+        out << " default "
+            << (option.default_value.empty() ? "<empty>"
+                                             : option.default_value);
+        if (option.type == Type::SPIN)
+            out << " min " << option.min << " max " << option.max;
+        out << "\n";
+    }
+}
+
+std::string UciOptions::set_from_command(const std::string &command) {
+    const auto name_pos = command.find("name ");
+    if (name_pos == std::string::npos)
+        return "setoption without a name";
+
+    const auto value_pos = command.find(" value ", name_pos);
+    const std::string name =
+        trim(command.substr(name_pos + 5, value_pos == std::string::npos
+                                              ? std::string::npos
+                                              : value_pos - name_pos - 5));
+    const std::string value = value_pos == std::string::npos
+                                  ? std::string()
+                                  : trim(command.substr(value_pos + 7));
+    return set(name, value);
+}
+
+std::string UciOptions::set(const std::string &name,
+                            const std::string &value) {
+    Option *option = find(name);
+    if (!option)
+        return "No such option: " + name;
+
+    std::string new_value = value == "<empty>" ? std::string() : value;
+    switch (option->type) {
+    case Type::SPIN: {
+        int number;
+        try {
+            number = std::stoi(new_value);
+        } catch (const std::exception &) {
+            return "Invalid value for " + option->name + ": " + value;
+        }
+        new_value = std::to_string(std::clamp(number, option->min, option->max));
+        break;
+    }
+    case Type::CHECK:
+        if (new_value != "true" && new_value != "false")
+            return "Invalid value for " + option->name + ": " + value;
+        break;
+    default:
+        break;
+    }
+
+    option->value = new_value;
+    if (option->on_change)
+        option->on_change(*option);
+    return {};
+}
+
+const UciOptions::Option &UciOptions::operator[](const std::string &name) const {
+    for (const auto &option : options_) {
+        if (same_name(option.name, name))
+            return option;
+    }
+    throw std::out_of_range("No such option: " + name);
+}
+
+UciOptions::Option *UciOptions::find(const std::string &name) {
+    for (auto &option : options_) {
+        if (same_name(option.name, name))
+            return &option;
+    }
+    return nullptr;
+}
+
+} // namespace chess::engine
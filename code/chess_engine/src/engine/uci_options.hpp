@@ -0,0 +1,56 @@
+#pragma once
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace chess::engine {
+
+// Typed UCI options in registration order. Every option has a callback
+// that applies a new value to the engine right away.
+class UciOptions {
+  public:
+    enum class Type { SPIN, CHECK, STRING, BUTTON };
+
+    struct Option {
+        std::string name;
+        Type type = Type::STRING;
+        std::string default_value;
+        int min = 0;
+        int max = 0;
+        std::string value;
+        std::function<void(const Option &)> on_change;
+
+        int as_int() const { return std::stoi(value); }
+        bool as_bool() const { return value == "true"; }
+    };
+    using Callback = std::function<void(const Option &)>;
+
+    void add_spin(const std::string &name, int default_value, int min, int max,
+                  Callback on_change = {});
+    void add_check(const std::string &name, bool default_value,
+                   Callback on_change = {});
+    void add_string(const std::string &name, const std::string &default_value,
+                    Callback on_change = {});
+    void add_button(const std::string &name, Callback on_press);
+
+    // "option name ... type ..." lines for the uci command
+    void print(std::ostream &out) const;
+
+    // Body of a setoption command: "name <id> [value <x>]". Names are case
+    // insensitive and may contain spaces. Returns an error message, empty
+    // on success.
+    std::string set_from_command(const std::string &command);
+    std::string set(const std::string &name, const std::string &value);
+
+    // Throws std::out_of_range for unknown names
+    const Option &operator[](const std::string &name) const;
+
+  private:
+    std::vector<Option> options_;
+
+    Option *find(const std::string &name);
+    Option &add(Option option);
+};
+
+} // namespace chess::engine
@@ -76,16 +76,7 @@ bool SDLGame::playerMoveFromTerminal() {
     }
 
     // Проверяем легальность хода
-    auto legalMoves = board.get_legal_moves({fromX, fromY});
-    bool moveIsLegal = false;
-    for (const auto &m : legalMoves) {
-        if (m.first == toX && m.second == toY) {
-            moveIsLegal = true;
-            break;
-        }
-    }
-
-    if (!moveIsLegal) {
+    if (!board.is_legal({{fromX, fromY}, {toX, toY}})) {
         std::cout << "Нелегальный ход. Попробуйте ещё раз.\n";
         return false;
     }
@@ -97,10 +88,10 @@ bool SDLGame::playerMoveFromTerminal() {
          (piece.get_color() == chess::Color::BLACK && toY == 7));
 
     if (isPromotionMove) {
-        board.make_move({fromX, fromY}, {toX, toY}, chess::PieceType::QUEEN);
+        playMove({fromX, fromY}, {toX, toY}, chess::PieceType::QUEEN);
         std::cout << "Пешка превращена в ферзя.\n";
     } else {
-        board.make_move({fromX, fromY}, {toX, toY});
+        playMove({fromX, fromY}, {toX, toY});
     }
 
     std::cout << "Ваш ход: " << from << " -> " << to << "  (" << fromX << fromY
@@ -122,7 +113,7 @@ SDLGame::SDLGame(bool vsComputer, bool vsLichess, bool withArduino, chess::Color
       isRunning(true), isDragging(false), vsComputer(vsComputer),
       vsLichess(vsLichess), withArduino(withArduino), dragStartX(-1), dragStartY(-1),
       computer(chess::engine::ComputerPlayer::create(computerColor, 3)),
-      board(), gameOver(false) {
+      board(), history(board), gameOver(false) {
     initSDL();
     initFIFO();
 }
@@ -185,7 +176,10 @@ void SDLGame::initFIFO() {
     }
 }
 
-SDLGame::~SDLGame() { cleanup(); }
+SDLGame::~SDLGame() {
+    stopPondering();
+    cleanup();
+}
 
 void SDLGame::initSDL() {
     // Инициализация SDL
@@ -405,7 +399,8 @@ void SDLGame::handleMouseDown(const SDL_Event &event) {
     if (gameOver) {
         if (isNewGameButtonClicked(event.button.x, event.button.y)) {
             gameOver = false;
-            board = chess::Board();
+            stopPondering();
+            setPosition(chess::BoardInitializer::STANDARD_FEN);
             if (vsComputer && computer->color_ == chess::Color::WHITE) {
                 makeComputerMove();
             }
@@ -454,16 +449,7 @@ void SDLGame::handleMouseUp(const SDL_Event &event) {
         const auto &piece = board.get_piece({dragStartX, dragStartY});
 
         // Проверяем легальность хода ДО его выполнения
-        auto legalMoves = board.get_legal_moves({dragStartX, dragStartY});
-        bool moveIsLegal = false;
-        for (const auto &m : legalMoves) {
-            if (m.first == targetX && m.second == targetY) {
-                moveIsLegal = true;
-                break;
-            }
-        }
-
-        if (!moveIsLegal) {
+        if (!board.is_legal({{dragStartX, dragStartY}, {targetX, targetY}})) {
             possibleMoves.clear();
             return; // Нелегальный ход - выходим
         }
@@ -481,11 +467,11 @@ void SDLGame::handleMouseUp(const SDL_Event &event) {
                 showPromotionDialog(piece.get_color());
 
             if (promotionChoice != chess::PieceType::NONE) {
-                board.make_move({dragStartX, dragStartY}, {targetX, targetY},
+                playMove({dragStartX, dragStartY}, {targetX, targetY},
                                 promotionChoice);
             }
         } else {
-            board.make_move({dragStartX, dragStartY}, {targetX, targetY});
+            playMove({dragStartX, dragStartY}, {targetX, targetY});
         }
 
         renderGame();
@@ -504,9 +490,80 @@ void SDLGame::handleMouseUp(const SDL_Event &event) {
     }
 }
 
+chess::engine::SearchLimits SDLGame::computerLimits() const {
+    chess::engine::SearchLimits limits;
+    limits.movetime = COMPUTER_MOVE_TIME_MS;
+    return limits;
+}
+
+void SDLGame::startPondering(const chess::engine::SearchResult &result) {
+    if (result.pv.size() < 2)
+        return;
+
+    // Позиция после ожидаемого ответа соперника
+    ponderBoard = board;
+    const auto &reply = result.pv[1];
+    if (!ponderBoard.make_move(reply.from, reply.to))
+        return;
+    ponderHistory = history;
+    ponderHistory.push(ponderBoard);
+
+    ponderSignals.stop = false;
+    ponderSignals.ponder = true;
+    ponderThread = std::thread([this, position = ponderBoard,
+                                positions = ponderHistory] {
+        ponderResult = computer->think(position, positions, computerLimits(),
+                                       ponderSignals);
+    });
+}
+
+std::optional<chess::engine::SearchResult> SDLGame::finishPondering() {
+    if (!ponderThread.joinable())
+        return std::nullopt;
+
+    const bool hit =
+        board.hash() == ponderBoard.hash();
+    if (hit) {
+        ponderSignals.ponder = false; // ponderhit
+    } else {
+        ponderSignals.stop = true;
+    }
+    ponderThread.join();
+    if (hit && !ponderResult.pv.empty())
+        return ponderResult;
+    return std::nullopt;
+}
+
+void SDLGame::stopPondering() {
+    if (ponderThread.joinable()) {
+        ponderSignals.stop = true;
+        ponderThread.join();
+    }
+}
+
+bool SDLGame::playMove(chess::Position from, chess::Position to,
+                       chess::PieceType promotion) {
+    if (!board.make_move(from, to, promotion))
+        return false;
+    history.push(board);
+    return true;
+}
+
+void SDLGame::setPosition(const std::string &fen) {
+    chess::BoardInitializer::setup_initial_position(board, fen);
+    history.reset(board);
+}
+
 std::string SDLGame::makeComputerMove() {
-    if (computer->makeMove(board)) {
-        auto lastMove = computer->getLastMove(); // Нужно реализовать, если нет
+    auto result = finishPondering();
+    if (!result) {
+        chess::engine::SearchSignals signals;
+        result = computer->think(board, history, computerLimits(), signals);
+    }
+
+    if (!result->pv.empty() &&
+        playMove(result->pv[0].from, result->pv[0].to)) {
+        auto lastMove = result->pv[0];
         std::string move = toChessNotation(lastMove.from.first, lastMove.from.second) +
                          toChessNotation(lastMove.to.first, lastMove.to.second);
         std::cout << "Компьютер ходит: " 
@@ -518,6 +575,7 @@ std::string SDLGame::makeComputerMove() {
                                    : chess::Color::WHITE)) {
             std::cout << "Checkmate! Computer wins!" << std::endl;
         }
+        startPondering(*result);
     }
     return "";
 }
@@ -525,8 +583,7 @@ std::string SDLGame::makeComputerMove() {
 void SDLGame::initializeFromFIFO() {
     if (fifo_lichess_in_fd == -1) {
         std::cerr << "FIFO не инициализирован" << std::endl;
-        chess::BoardInitializer::setup_initial_position(
-            board, chess::BoardInitializer::STANDARD_FEN);
+        setPosition(chess::BoardInitializer::STANDARD_FEN);
         return;
     }
 
@@ -538,8 +595,7 @@ void SDLGame::initializeFromFIFO() {
     bytes_read = read(fifo_lichess_in_fd, buffer, 1);
     if (bytes_read <= 0) {
         std::cerr << "Ошибка чтения из FIFO: " << strerror(errno) << std::endl;
-        chess::BoardInitializer::setup_initial_position(
-            board, chess::BoardInitializer::STANDARD_FEN);
+        setPosition(chess::BoardInitializer::STANDARD_FEN);
         return;
     }
 
@@ -570,13 +626,12 @@ void SDLGame::initializeFromFIFO() {
 
     if (initial_data.find("fen ") == 0) {
         std::string fen = initial_data.substr(4);
-        chess::BoardInitializer::setup_initial_position(board, fen);
+        setPosition(fen);
         std::cout << "Инициализировано из FEN: " << fen << std::endl;
     } else {
         std::cerr << "Неизвестный формат инициализации: " << initial_data << std::endl;
                   
-        chess::BoardInitializer::setup_initial_position(
-            board, chess::BoardInitializer::STANDARD_FEN);
+        setPosition(chess::BoardInitializer::STANDARD_FEN);
     }
 }
 
@@ -623,16 +678,7 @@ std::string SDLGame::processFIFOMove(const int fifo_in_fd) {
                 return "";
 
             // std::cout << "Move from FIFO3: " << std::endl;
-            auto legalMoves = board.get_legal_moves({fromX, fromY});
-            bool moveIsLegal = false;
-            for (const auto &m : legalMoves) {
-                if (m.first == toX && m.second == toY) {
-                    moveIsLegal = true;
-                    break;
-                }
-            }
-            // std::cout << "Move from FIFO4: " << std::endl;
-            if (!moveIsLegal)
+            if (!board.is_legal({{fromX, fromY}, {toX, toY}}))
                 return "";
 
             // std::cout << "Move from FIFO5: " << std::endl;
@@ -643,10 +689,10 @@ std::string SDLGame::processFIFOMove(const int fifo_in_fd) {
 
             // std::cout << "Move from FIFO6: " << std::endl;
             if (isPromotionMove) {
-                board.make_move({fromX, fromY}, {toX, toY},
+                playMove({fromX, fromY}, {toX, toY},
                                 chess::PieceType::QUEEN);
             } else {
-                board.make_move({fromX, fromY}, {toX, toY});
+                playMove({fromX, fromY}, {toX, toY});
             }
 
             return move;
@@ -1,11 +1,15 @@
 #pragma once
 #include "board/board.hpp"
+#include "board/position_history.hpp"
 #include "engine/computer_player.hpp"
+#include "engine/search.hpp"
 #include "pieces/piece.hpp"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
+#include <optional>
 #include <string>
+#include <thread>
 
 class SDLGame {
   public:
@@ -40,6 +44,21 @@ class SDLGame {
     void handleMouseMotion(const SDL_Event &event);
     void handleMouseUp(const SDL_Event &event);
     std::string makeComputerMove();
+    // Ход на доске вместе с записью позиции в историю партии
+    bool playMove(chess::Position from, chess::Position to,
+                  chess::PieceType promotion = chess::PieceType::NONE);
+    // Новая позиция на доске начинает историю заново
+    void setPosition(const std::string &fen);
+
+    // Обдумывание на времени соперника: после своего хода компьютер ищет
+    // позицию после ожидаемого ответа (второй ход PV), пока человек
+    // выбирает и перетаскивает фигуру
+    void startPondering(const chess::engine::SearchResult &result);
+    // Ответ угадан - поиск доигрывает оставшееся время и отдаёт результат,
+    // иначе прерывается
+    std::optional<chess::engine::SearchResult> finishPondering();
+    void stopPondering();
+    chess::engine::SearchLimits computerLimits() const;
     void cleanup();
     void renderGameOverMessage();
     void renderNewGameButton();
@@ -58,6 +77,7 @@ class SDLGame {
     TTF_Font *font;
     SDL_Texture *piecesTexture;
     chess::Board board;
+    chess::PositionHistory history; // позиции партии до board включительно
     std::unique_ptr<chess::engine::ComputerPlayer> computer;
     bool isRunning;
     bool isDragging;
@@ -68,4 +88,13 @@ class SDLGame {
     SDL_Rect dragRect;
     chess::Piece draggedPiece;
     std::vector<std::pair<int, int>> possibleMoves;
+
+    // Время на ход компьютера; при угаданном ответе в него засчитывается
+    // время обдумывания на ходе соперника
+    static constexpr int COMPUTER_MOVE_TIME_MS = 1000;
+    std::thread ponderThread;
+    chess::engine::SearchSignals ponderSignals;
+    chess::Board ponderBoard;
+    chess::PositionHistory ponderHistory;
+    chess::engine::SearchResult ponderResult;
 };
\ No newline at end of file
@@ -19,6 +19,9 @@ int main(int argc, char *argv[]) {
                     computerColor = chess::Color::WHITE;
             }
         }
+        if (arg == "--book" && i + 1 < argc) {
+            chess::engine::OpeningBook::setSharedPath(argv[++i]);
+        }
         if (arg == "--lichess" || arg == "-c") {
             vsLichess = true;
             if (i + 1 < argc) {
@@ -29,6 +32,8 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    chess::engine::OpeningBook::preloadShared();
+
     try {
         SDLGame game(vsComputer, vsLichess, true, computerColor);
 
@@ -1,45 +1,104 @@
 #include "board/board.hpp"
+#include "board/initialization.hpp"
+#include "board/position_history.hpp"
+#include "engine/bench.hpp"
 #include "engine/computer_player.hpp"
 #include "engine/move_generator.hpp"
+#include "engine/nnue_evaluator.hpp"
+#include "engine/position_evaluator.hpp"
+#include "engine/uci_options.hpp"
 #include "pieces/piece.hpp"
+#include <algorithm>
+#include <condition_variable>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
 class EngineUCI {
   private:
     chess::Board board;
+    // Позиции партии до board включительно - для повторений в поиске
+    chess::PositionHistory history{board};
     unique_ptr<chess::engine::ComputerPlayer> computer;
-    bool isBotTurn = false;
-    chess::Color botColor; // Храним цвет, за который играет бот
+    chess::engine::UciOptions options;
+
+    // Что сейчас стоит на доске: начальная позиция из команды position
+    // и применённые к ней ходы. Следующая команда position обычно лишь
+    // дописывает ходы, и тогда применяется только новый хвост.
+    string positionBase;
+    vector<string> appliedMoves;
+
+    // Поиск идёт в отдельном потоке, чтобы stop, ponderhit, isready и quit
+    // обрабатывались во время обдумывания
+    thread searchThread;
+    chess::engine::SearchSignals signals;
+    mutex signalMutex; // вместе с signalChanged будит ожидающий bestmove
+    condition_variable signalChanged;
+    mutex outputMutex;
 
   public:
-    EngineUCI()
-        : botColor(chess::Color::BLACK) { // По умолчанию бот играет чёрными
-        initializeComputerPlayer(botColor);
+    EngineUCI() {
+        // Цвет не важен: думаем за ту сторону, чей ход в позиции
+        computer = chess::engine::ComputerPlayer::create(chess::Color::WHITE, 3);
+        registerOptions();
     }
 
+    ~EngineUCI() { stopSearch(); }
+
     void receiveCommand(const string &message) {
         string messageType = message.substr(0, message.find(' '));
 
         if (messageType == "uci") {
             respond("id name ChessEngine");
             respond("id author YourName");
+            ostringstream list;
+            options.print(list);
+            string text = list.str();
+            if (!text.empty()) {
+                text.pop_back();
+                respond(text);
+            }
             respond("uciok");
         } else if (messageType == "isready") {
             respond("readyok");
         } else if (messageType == "ucinewgame") {
+            stopSearch();
+            computer->generator().clear_hash();
             board = chess::Board();
+            history.reset(board);
+            positionBase.clear();
+            appliedMoves.clear();
             // При новой игре бот остаётся играть тем же цветом
+        } else if (messageType == "setoption") {
+            stopSearch();
+            string error = options.set_from_command(message);
+            if (!error.empty()) {
+                respond("info string " + error);
+            }
         } else if (messageType == "position") {
+            stopSearch();
             processPositionCommand(message);
         } else if (messageType == "go") {
-            isBotTurn = true;
             processGoCommand(message);
+        } else if (messageType == "stop") {
+            stopSearch();
+        } else if (messageType == "ponderhit") {
+            setSignal(signals.ponder, false);
+        } else if (messageType == "bench") {
+            // Нестандартная команда, как в Stockfish: bench [хеш] [потоки] [глубина]
+            stopSearch();
+            // Отдельный генератор с чистой таблицей: настройки и таблица
+            // игры не влияют на подпись и не портятся замером
+            chess::engine::run_bench_command(message.substr(5), cerr);
         } else if (messageType == "quit") {
+            stopSearch();
             exit(0);
         } else {
             cerr << "Unrecognized command: " << messageType << endl;
@@ -47,42 +106,136 @@ class EngineUCI {
     }
 
   private:
-    void respond(const string &response) { cout << response << endl; }
-
-    void initializeComputerPlayer(chess::Color color) {
-        computer = chess::engine::ComputerPlayer::create(color, 3);
-        botColor = color;
+    void respond(const string &response) {
+        lock_guard<mutex> lock(outputMutex);
+        cout << response << endl;
     }
 
-    void processPositionCommand(const string &message) {
-        size_t startpos = message.find("startpos");
-        if (startpos != string::npos) {
-            board = chess::Board();
-        } else {
-            size_t fenpos = message.find("fen ");
-            if (fenpos != string::npos) {
-                string fen = message.substr(fenpos + 4,
-                                            message.find("moves") - fenpos - 4);
-                board = chess::Board(fen);
+    // Каждая опция применяется сразу, без перезапуска движка
+    void registerOptions() {
+        using chess::engine::UciOptions;
+        options.add_spin("Hash", chess::engine::TranspositionTable::DEFAULT_SIZE_MB,
+                         1, 4096, [this](const UciOptions::Option &option) {
+                             computer->generator().set_hash_size(option.as_int());
+                         });
+        options.add_button("Clear Hash", [this](const UciOptions::Option &) {
+            computer->generator().clear_hash();
+        });
+        options.add_spin("MultiPV", 1, 1, 64);
+        options.add_spin("Threads", 1, 1, 64,
+                         [this](const UciOptions::Option &option) {
+                             computer->generator().set_threads(option.as_int());
+                         });
+        // Глубина для go без ограничений
+        options.add_spin("Depth", 3, 1, 63);
+        options.add_spin("Move Overhead", 10, 0, 5000);
+        // Только сообщает GUI, что движок умеет go ponder: обдумывать на
+        // чужом времени без команды от GUI движок не начинает
+        options.add_check("Ponder", false);
+        options.add_check("OwnBook", true,
+                          [this](const UciOptions::Option &option) {
+                              computer->setUseBook(option.as_bool());
+                          });
+        options.add_string("BookFile", chess::engine::OpeningBook::sharedPath(),
+                           [](const UciOptions::Option &option) {
+                               chess::engine::OpeningBook::setSharedPath(option.value);
+                               chess::engine::OpeningBook::preloadShared();
+                           });
+        // Пустое значение - классическая оценка
+        options.add_string("EvalFile", "", [this](const UciOptions::Option &option) {
+            unique_ptr<chess::engine::Evaluator> evaluator;
+            try {
+                if (option.value.empty()) {
+                    evaluator = make_unique<chess::engine::PositionEvaluator>();
+                } else {
+                    evaluator = make_unique<chess::engine::NnueEvaluator>(option.value);
+                }
+            } catch (const exception &e) {
+                respond("info string " + string(e.what()));
+                return;
             }
+            computer->generator().set_evaluator(move(evaluator));
+        });
+    }
+
+    void setSignal(atomic<bool> &signal, bool value) {
+        {
+            lock_guard<mutex> lock(signalMutex);
+            signal = value;
+        }
+        signalChanged.notify_all();
+    }
+
+    void stopSearch() {
+        if (searchThread.joinable()) {
+            setSignal(signals.stop, true);
+            searchThread.join();
         }
+    }
 
+    void processPositionCommand(const string &message) {
         size_t movespos = message.find("moves");
+        string base = message.substr(0, movespos);
+        base.erase(base.find_last_not_of(' ') + 1);
+
+        vector<string> moves;
         if (movespos != string::npos) {
-            string moves = message.substr(movespos + 5);
-            istringstream iss(moves);
+            istringstream iss(message.substr(movespos + 5));
             string move;
             while (iss >> move) {
-                if (!processMove(move)) {
-                    cerr << "Illegal move: " << move << endl;
-                    return;
-                }
+                moves.push_back(move);
             }
         }
 
+        // Новый список продолжает уже применённый - доигрываем только хвост
+        size_t first = 0;
+        if (!positionBase.empty() && base == positionBase &&
+            moves.size() >= appliedMoves.size() &&
+            equal(appliedMoves.begin(), appliedMoves.end(), moves.begin())) {
+            first = appliedMoves.size();
+        } else if (!resetPosition(base)) {
+            return;
+        }
+
+        for (size_t i = first; i < moves.size(); ++i) {
+            if (!processMove(moves[i])) {
+                cerr << "Illegal move: " << moves[i] << endl;
+                // Доска не соответствует списку - следующая команда
+                // соберёт позицию заново
+                positionBase.clear();
+                return;
+            }
+            appliedMoves.push_back(moves[i]);
+        }
+
         // Не меняем цвет бота здесь - он определяется при инициализации
     }
 
+    // При ошибке остаётся прежняя позиция
+    bool resetPosition(const string &base) {
+        chess::Board newBoard;
+        if (base.find("startpos") == string::npos) {
+            size_t fenpos = base.find("fen ");
+            if (fenpos == string::npos) {
+                cerr << "Invalid position command" << endl;
+                return false;
+            }
+            auto error = chess::BoardInitializer::try_setup_position(
+                newBoard, string_view(base).substr(fenpos + 4));
+            if (error) {
+                respond("info string Invalid FEN at offset " +
+                        to_string(error->offset) + ": " + error->message);
+                return false;
+            }
+        }
+
+        board = newBoard;
+        appliedMoves.clear();
+        history.reset(board);
+        positionBase = base;
+        return true;
+    }
+
     bool processMove(const string &moveStr) {
         if (moveStr.length() < 4)
             return false;
@@ -92,45 +245,182 @@ class EngineUCI {
         int toX = moveStr[2] - 'a';
         int toY = '8' - moveStr[3];
 
-        // Проверяем легальность хода перед выполнением
-        auto legalMoves = board.get_legal_moves({fromX, fromY});
-        bool isLegal = false;
-        for (const auto &m : legalMoves) {
-            if (m.first == toX && m.second == toY) {
-                isLegal = true;
-                break;
+        chess::PieceType promotion = chess::PieceType::NONE;
+        if (moveStr.length() > 4) {
+            switch (moveStr[4]) {
+                case 'n':
+                    promotion = chess::PieceType::KNIGHT;
+                    break;
+                case 'b':
+                    promotion = chess::PieceType::BISHOP;
+                    break;
+                case 'r':
+                    promotion = chess::PieceType::ROOK;
+                    break;
+                case 'q':
+                    promotion = chess::PieceType::QUEEN;
+                    break;
+                default:
+                    return false;
             }
         }
 
-        if (!isLegal)
+        // make_move сам проверяет легальность через Board::is_legal
+        if (!board.make_move({fromX, fromY}, {toX, toY}, promotion))
             return false;
-
-        return board.make_move({fromX, fromY}, {toX, toY});
+        history.push(board);
+        return true;
     }
 
     void processGoCommand(const string &message) {
-        if (!isBotTurn || board.current_player != botColor) {
-            // Бот ходит только когда его очередь и цвет совпадает
-            return;
+        stopSearch();
+
+        chess::engine::SearchLimits limits;
+        bool ponder = false;
+        istringstream iss(message.substr(2));
+        string token;
+        while (iss >> token) {
+            if (token == "infinite") {
+                limits.infinite = true;
+            } else if (token == "ponder") {
+                ponder = true;
+            } else if (token == "depth") {
+                iss >> limits.depth;
+            } else if (token == "nodes") {
+                iss >> limits.nodes;
+            } else if (token == "movetime") {
+                iss >> limits.movetime;
+            } else if (token == "mate") {
+                iss >> limits.mate;
+            } else if (token == "wtime") {
+                iss >> limits.time[0];
+            } else if (token == "btime") {
+                iss >> limits.time[1];
+            } else if (token == "winc") {
+                iss >> limits.increment[0];
+            } else if (token == "binc") {
+                iss >> limits.increment[1];
+            } else if (token == "movestogo") {
+                iss >> limits.movestogo;
+            }
         }
 
-        if (computer->makeMove(board)) {
-            chess::engine::Move move = computer->getLastMove();
-            string bestmove = string(1, 'a' + move.from.first) +
-                              to_string(8 - move.from.second) +
-                              string(1, 'a' + move.to.first) +
-                              to_string(8 - move.to.second);
+        limits.move_overhead = options["Move Overhead"].as_int();
+        limits.multipv = options["MultiPV"].as_int();
+        const bool unlimited = !limits.infinite && !ponder && limits.depth == 0 &&
+                               limits.nodes == 0 && limits.movetime == 0 &&
+                               limits.mate == 0 && limits.time[0] == 0 &&
+                               limits.time[1] == 0;
+        if (unlimited) {
+            limits.depth = options["Depth"].as_int();
+        }
 
-            respond("bestmove " + bestmove);
-        } else {
+        signals.stop = false;
+        signals.ponder = ponder;
+        searchThread = thread([this, limits, position = board,
+                               positions = history] {
+            search(position, positions, limits);
+        });
+    }
+
+    // Тело потока поиска
+    void search(const chess::Board &position,
+                const chess::PositionHistory &positions,
+                const chess::engine::SearchLimits &limits) {
+        auto result = computer->think(
+            position, positions, limits, signals,
+            [&](const chess::engine::SearchInfo &info) {
+                sendInfo(position, info);
+            });
+
+        // В режимах infinite и ponder bestmove отправляется только после
+        // stop (или ponderhit), даже если поиск закончился раньше
+        {
+            unique_lock<mutex> lock(signalMutex);
+            signalChanged.wait(lock, [&] {
+                return signals.stop || (!limits.infinite && !signals.ponder);
+            });
+        }
+
+        if (chess::engine::SearchStats::enabled && result.stats.nodes > 0) {
+            respond("info string " + result.stats.summary());
+        }
+        if (result.pv.empty()) {
             // Если нет возможных ходов (мат или пат)
             respond("bestmove 0000");
+            return;
+        }
+        string bestmove = "bestmove " + moveToUci(position, result.pv[0]);
+        if (result.pv.size() > 1) {
+            chess::Board next = position;
+            next.apply_move(result.pv[0]);
+            bestmove += " ponder " + moveToUci(next, result.pv[1]);
         }
-        isBotTurn = false;
+        respond(bestmove);
+    }
+
+    void sendInfo(const chess::Board &root,
+                  const chess::engine::SearchInfo &info) {
+        const long long nps =
+            info.time_ms > 0 ? static_cast<long long>(info.nodes * 1000 / info.time_ms)
+                             : 0;
+        ostringstream line;
+        line << "info";
+        if (!info.pv.empty()) {
+            line << " depth " << info.depth << " seldepth " << info.seldepth
+                 << " multipv " << info.multipv << " score ";
+            if (chess::engine::is_mate_score(info.score)) {
+                line << "mate " << chess::engine::mate_in_moves(info.score);
+            } else {
+                line << "cp " << info.score;
+            }
+        }
+        line << " nodes " << info.nodes << " nps " << nps << " hashfull "
+             << info.hashfull << " time " << info.time_ms;
+        if (!info.pv.empty()) {
+            line << " pv";
+            chess::Board position = root;
+            for (const auto &move : info.pv) {
+                line << " " << moveToUci(position, move);
+                position.apply_move(move);
+            }
+        }
+        respond(line.str());
+    }
+
+    // Координаты хода плюс фигура превращения (всегда ферзь)
+    static string moveToUci(const chess::Board &position,
+                            const chess::engine::Move &move) {
+        string result = string(1, 'a' + move.from.first) +
+                        to_string(8 - move.from.second) +
+                        string(1, 'a' + move.to.first) +
+                        to_string(8 - move.to.second);
+        if (position.get_piece(move.from).get_type() == chess::PieceType::PAWN &&
+            (move.to.second == 0 || move.to.second == 7)) {
+            result += 'q';
+        }
+        return result;
     }
 };
 
-int main() {
+int main(int argc, char *argv[]) {
+    // lichess_bot bench [хеш] [потоки] [глубина] - замер и выход
+    if (argc > 1 && string(argv[1]) == "bench") {
+        string args;
+        for (int i = 2; i < argc; ++i) {
+            args += string(argv[i]) + " ";
+        }
+        return chess::engine::run_bench_command(args, cerr);
+    }
+
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (string(argv[i]) == "--book") {
+            chess::engine::OpeningBook::setSharedPath(argv[++i]);
+        }
+    }
+    // Загружаем книгу до первой команды go
+    chess::engine::OpeningBook::preloadShared();
+
     EngineUCI engine;
     string line;
 
@@ -3,55 +3,77 @@
 #include "pieces/piece_color.hpp"
 #include "pieces/piece_symbols.hpp"
 #include "pieces/piece_types.hpp"
+#include <cstdint>
 #include <string>
 
 namespace chess {
 
+// Один байт: тип в младших трёх битах и BLACK у чёрных фигур - тот же код,
+// что в Board::piece_codes(). Цвет клетки считают те, кто рисует доску.
 class Piece {
   public:
-    Piece() = default;
-    Piece(PieceType type, Color color, CellColor cellColor = CellColor::WHITE)
-        : type_(type), color_(color), cellColor_(cellColor) {}
+    static constexpr std::uint8_t TYPE_MASK = 7;
+    static constexpr std::uint8_t BLACK = 8;
+
+    constexpr Piece() = default;
+    // У пустой клетки цвета нет: её код всегда 0
+    constexpr Piece(PieceType type, Color color)
+        : code_(type == PieceType::NONE
+                    ? 0
+                    : static_cast<std::uint8_t>(
+                          static_cast<std::uint8_t>(type) |
+                          (color == Color::BLACK ? BLACK : 0))) {}
+
+    static constexpr Piece from_code(std::uint8_t code) {
+        Piece piece;
+        piece.code_ = code;
+        return piece;
+    }
 
     // Геттеры
-    PieceType get_type() const { return type_; }
-    Color get_color() const { return color_; }
-    CellColor get_cell_color() const { return cellColor_; }
+    constexpr PieceType get_type() const {
+        return static_cast<PieceType>(code_ & TYPE_MASK);
+    }
+    constexpr Color get_color() const {
+        return code_ & BLACK ? Color::BLACK : Color::WHITE;
+    }
+    constexpr std::uint8_t code() const { return code_; }
 
     // Сеттеры
-    void set_type(PieceType type) { type_ = type; }
-    void set_color(Color color) { color_ = color; }
-    void set_cell_color(CellColor color) { cellColor_ = color; }
+    void set_type(PieceType type) { *this = Piece(type, get_color()); }
+    void set_color(Color color) { *this = Piece(get_type(), color); }
 
     std::string getSymbol(PieceSet set = PieceSet::UNICODE) const {
-        return PieceSymbols::get(type_, color_, set);
+        return PieceSymbols::get(get_type(), get_color(), set);
     }
 
     char to_char() const {
-        switch (type_) {
+        const Color color = get_color();
+        switch (get_type()) {
             case PieceType::PAWN:
-                return (color_ == Color::WHITE) ? 'P' : 'p';
+                return (color == Color::WHITE) ? 'P' : 'p';
             case PieceType::KNIGHT:
-                return (color_ == Color::WHITE) ? 'N' : 'n';
+                return (color == Color::WHITE) ? 'N' : 'n';
             case PieceType::BISHOP:
-                return (color_ == Color::WHITE) ? 'B' : 'b';
+                return (color == Color::WHITE) ? 'B' : 'b';
             case PieceType::ROOK:
-                return (color_ == Color::WHITE) ? 'R' : 'r';
+                return (color == Color::WHITE) ? 'R' : 'r';
             case PieceType::QUEEN:
-                return (color_ == Color::WHITE) ? 'Q' : 'q';
+                return (color == Color::WHITE) ? 'Q' : 'q';
             case PieceType::KING:
-                return (color_ == Color::WHITE) ? 'K' : 'k';
+                return (color == Color::WHITE) ? 'K' : 'k';
             case PieceType::NONE:
                 return '.';
         }
         return '?'; // На случай ошибки
     }
 
-    std::string getColoredSymbol(PieceSet set = PieceSet::UNICODE) const {
-        std::string symbol = PieceSymbols::get(type_, color_, set);
-        const auto &codes = getColorCodes(cellColor_);
-        const char *fg = (color_ == Color::WHITE) ? codes.foreground_white
-                                                  : codes.foreground_black;
+    std::string getColoredSymbol(CellColor cellColor,
+                                 PieceSet set = PieceSet::UNICODE) const {
+        std::string symbol = PieceSymbols::get(get_type(), get_color(), set);
+        const auto &codes = getColorCodes(cellColor);
+        const char *fg = (get_color() == Color::WHITE) ? codes.foreground_white
+                                                       : codes.foreground_black;
 
         std::string result;
         result.reserve(32);
@@ -66,9 +88,7 @@ class Piece {
     }
 
   private:
-    PieceType type_ = PieceType::NONE;
-    Color color_ = Color::WHITE;
-    CellColor cellColor_ = CellColor::WHITE;
+    std::uint8_t code_ = 0;
 };
 
 } // namespace chess
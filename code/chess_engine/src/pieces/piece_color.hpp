@@ -1,8 +1,9 @@
 #pragma once
+#include <cstdint>
 
 namespace chess {
 
-enum class Color { WHITE, BLACK };
+enum class Color : std::uint8_t { WHITE, BLACK };
 enum class CellColor { WHITE, BLACK, HIGHLIGHT_WHITE, HIGHLIGHT_BLACK };
 
 struct ColorCodes {
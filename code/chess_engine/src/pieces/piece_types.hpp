@@ -1,8 +1,9 @@
 #pragma once
+#include <cstdint>
 
 namespace chess {
 
-enum class PieceType {
+enum class PieceType : std::uint8_t {
     NONE,
     PAWN,
     KNIGHT,